@@ -1,5 +1,7 @@
 #include "components.h"
 
+#include <algorithm>
+
 using namespace components;
 
 TransformComponent::TransformComponent() : x(0), y(0) {}
@@ -21,22 +23,40 @@ float TransformComponent::get_y() { return this->y; }
 void TransformComponent::move(float x, float y) {
     this->x += x;
     this->y += y;
+    this->entity.mark_changed<TransformComponent>();
 }
 
 bool CameraComponent::is_unique() { return true; }
 
 CameraComponent::CameraComponent(float aspect_ratio, float scale)
-    : aspect_ratio(aspect_ratio), scale(scale) {}
+    : aspect_ratio(aspect_ratio),
+      scale(scale),
+      view_uploaded(false),
+      view_tick(0) {}
 
 void CameraComponent::init(core::Interface &interface) {
-    this->transform = &this->entity->get_single_component<TransformComponent>();
     interface.get_renderer().upload_ortho(
         -1 * this->aspect_ratio, 1 * this->aspect_ratio, -1, 1, 0.1f, 100);
 }
 
 void CameraComponent::update(core::Interface &interface) {
-    float x = this->transform->get_x();
-    float y = this->transform->get_y();
+    (void)(interface);
+}
+
+void CameraComponent::render(core::Interface &interface) {
+    // only upload the view again after the camera moved
+    if (this->view_uploaded &&
+        this->entity.get_changed_tick<TransformComponent>() < this->view_tick) {
+        return;
+    }
+    this->view_uploaded = true;
+    this->view_tick = interface.get_game().get_tick();
+    // components move in memory on structural changes, so the transform
+    // is looked up again instead of being kept around
+    TransformComponent &transform =
+        this->entity.get_single_component<TransformComponent>();
+    float x = transform.get_x();
+    float y = transform.get_y();
     interface.get_renderer().upload_view(x, y, 0, 1.0f / this->scale);
 }
 
@@ -61,34 +81,99 @@ size_t ChunkPos::as_long() {
 }
 
 TilemapChunk::TilemapChunk(ChunkPos pos, uint16_t chunk_size)
-    : pos(pos), chunk_size(chunk_size), tiles(chunk_size * chunk_size, 0) {}
+    : pos(pos),
+      chunk_size(chunk_size),
+      tiles(chunk_size * chunk_size, 0),
+      dirty(true),
+      has_mesh(false) {}
 
 void TilemapChunk::set_tile(uint16_t x, uint16_t y, uint16_t tile) {
     uint32_t index = ((uint32_t)y * (uint32_t)chunk_size) + (uint32_t)x;
-    tiles[(size_t)index] = tile;
+    if (tiles[(size_t)index] != tile) {
+        tiles[(size_t)index] = tile;
+        this->dirty = true;
+    }
 }
 
-void TilemapChunk::render(TilemapComponent &tilemap, render::Renderer &renderer,
-                          float render_size) {
-    renderer.batch_draw_quad_begin();
+void TilemapChunk::bake(TilemapComponent &tilemap, render::StateCache &state,
+                        float render_size) {
+    // tiles are grouped by texture, so every texture of the chunk is a
+    // single range of the index buffer
+    std::vector<std::pair<GLuint, uint32_t>> order;
     for (uint32_t i = 0; i < (uint32_t)this->tiles.size(); i++) {
-        uint16_t tile = this->tiles[i];
-        uint32_t x =
-            this->pos.x * this->chunk_size + (i % (uint32_t)chunk_size);
-        uint32_t y =
-            this->pos.y * this->chunk_size + (i / (uint32_t)chunk_size);
-        if (tile) {
-            Tile &tile_type = tilemap.get_tile_type(tile);
-            renderer.batch_upload_transform(
-                render::Transform3D()
-                    .translate(render_size * ((float)x + 0.5f),
-                               render_size * ((float)y + 0.5f), 0)
-                    .scale(render_size, render_size, render_size));
-            renderer.batch_bind_texture(tile_type.texture);
-            renderer.batch_draw_quad();
+        if (this->tiles[i]) {
+            Tile &tile_type = tilemap.get_tile_type(this->tiles[i]);
+            order.push_back({tile_type.texture.texture.get_texture(), i});
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const std::pair<GLuint, uint32_t> &a,
+                        const std::pair<GLuint, uint32_t> &b) {
+                         return a.first < b.first;
+                     });
+    std::vector<float> vertices;
+    std::vector<float> uvs;
+    std::vector<int> indices;
+    vertices.reserve(order.size() * 12);
+    uvs.reserve(order.size() * 8);
+    indices.reserve(order.size() * 6);
+    this->draws.clear();
+    for (auto &entry : order) {
+        uint32_t i = entry.second;
+        Tile &tile_type = tilemap.get_tile_type(this->tiles[i]);
+        if (this->draws.empty() ||
+            this->draws.back().texture.get_texture() != entry.first) {
+            this->draws.push_back(ChunkDraw{tile_type.texture.texture,
+                                            (GLsizei)indices.size(), 0});
         }
+        float x0 = render_size * (float)(this->pos.x * this->chunk_size +
+                                         (i % (uint32_t)chunk_size));
+        float y0 = render_size * (float)(this->pos.y * this->chunk_size +
+                                         (i / (uint32_t)chunk_size));
+        float x1 = x0 + render_size;
+        float y1 = y0 + render_size;
+        std::array<float, 4> rect = tile_type.texture.get_uv_rect();
+        float u0 = rect[0];
+        float v0 = rect[1];
+        float u1 = rect[0] + rect[2];
+        float v1 = rect[1] + rect[3];
+        // same corners and uvs as the renderer's quad
+        int base = (int)(vertices.size() / 3);
+        vertices.insert(vertices.end(),
+                        {x0, y1, 0, x0, y0, 0, x1, y0, 0, x1, y1, 0});
+        uvs.insert(uvs.end(), {u0, v0, u0, v1, u1, v1, u1, v0});
+        indices.insert(indices.end(), {base, base + 1, base + 2, base + 2,
+                                       base + 3, base});
+        this->draws.back().count += 6;
     }
-    renderer.batch_draw_quad_end();
+    if (this->has_mesh) {
+        this->mesh.update(vertices, uvs, indices);
+    } else {
+        this->mesh = render::Mesh(vertices, uvs, indices, &state);
+        this->has_mesh = true;
+    }
+    this->dirty = false;
+}
+
+void TilemapChunk::render(TilemapComponent &tilemap, render::Renderer &renderer,
+                          float render_size) {
+    if (this->dirty) {
+        this->bake(tilemap, renderer.get_state(), render_size);
+    }
+    if (this->draws.empty()) {
+        return;
+    }
+    // chunks are nodes of the tilemap's map, so they stay put until the
+    // queue is flushed at the end of the frame. capturing just the chunk
+    // keeps the draw small enough for std::function not to allocate.
+    TilemapChunk *chunk = this;
+    renderer.get_queue().submit(0, 0, [chunk](render::Renderer &renderer) {
+        render::Transform3D transform;
+        for (ChunkDraw &draw : chunk->draws) {
+            renderer.draw_mesh(chunk->mesh.get_vao(), draw.texture, transform,
+                               draw.first, draw.count);
+        }
+    });
 }
 
 TilemapComponent::TilemapComponent(uint16_t chunk_size, float render_tile_size,
@@ -100,14 +185,12 @@ TilemapComponent::TilemapComponent(uint16_t chunk_size, float render_tile_size,
 bool TilemapComponent::is_unique() { return true; }
 
 void TilemapComponent::init(core::Interface &interface) {
-    core::Entity &camera_entity =
-        interface.get_game().get_entity(this->camera_id);
-    this->cam_transform =
-        &camera_entity.get_single_component<TransformComponent>();
-    this->camera = &camera_entity.get_single_component<CameraComponent>();
+    (void)(interface);
 }
 
-bool TilemapComponent::should_chunk_render(ChunkPos pos) {
+bool TilemapComponent::should_chunk_render(ChunkPos pos,
+                                           TransformComponent &cam_transform,
+                                           CameraComponent &camera) {
     float minx =
         this->render_tile_size * (float)this->chunk_size * (float)pos.x;
     float miny =
@@ -116,10 +199,10 @@ bool TilemapComponent::should_chunk_render(ChunkPos pos) {
         this->render_tile_size * (float)this->chunk_size * (float)(pos.x + 1);
     float maxy =
         this->render_tile_size * (float)this->chunk_size * (float)(pos.y + 1);
-    float camx = this->cam_transform->get_x();
-    float camy = this->cam_transform->get_y();
-    float sc = this->camera->get_scale();
-    float ar = this->camera->get_aspect_ratio() * sc;
+    float camx = cam_transform.get_x();
+    float camy = cam_transform.get_y();
+    float sc = camera.get_scale();
+    float ar = camera.get_aspect_ratio() * sc;
     /*
     logger.debug_stream() << "minx: " << minx << ", "
                           << "miny: " << miny << ", "
@@ -133,10 +216,23 @@ bool TilemapComponent::should_chunk_render(ChunkPos pos) {
 }
 
 void TilemapComponent::update(core::Interface &interface) {
+    (void)(interface);
+}
+
+void TilemapComponent::render(core::Interface &interface) {
     render::Renderer &renderer = interface.get_renderer();
+    // the camera's components are looked up every frame, references into
+    // the game's storage don't survive structural changes
+    core::Entity camera_entity =
+        interface.get_game().get_entity(this->camera_id);
+    TransformComponent &cam_transform =
+        camera_entity.get_single_component<TransformComponent>();
+    CameraComponent &camera =
+        camera_entity.get_single_component<CameraComponent>();
     // size_t chunk_draw_count = 0;
     for (auto &chunk_pair : this->chunks) {
-        if (this->should_chunk_render(ChunkPos(chunk_pair.first))) {
+        if (this->should_chunk_render(ChunkPos(chunk_pair.first),
+                                      cam_transform, camera)) {
             chunk_pair.second.render(*this, renderer, this->render_tile_size);
             // chunk_draw_count++;
         }
@@ -178,8 +274,8 @@ void TilemapComponent::set_tile(uint32_t x, uint32_t y, Tile &tile) {
     uint16_t tile_id = this->tiles_to_ids.at(tile);
     ChunkPos chunk_pos = this->get_chunk_pos_from_pos(x, y);
     if (this->chunks.find(chunk_pos.as_long()) == this->chunks.end()) {
-        this->chunks.insert(
-            {chunk_pos.as_long(), TilemapChunk(chunk_pos, this->chunk_size)});
+        this->chunks.emplace(chunk_pos.as_long(),
+                             TilemapChunk(chunk_pos, this->chunk_size));
     }
     TilemapChunk &chunk = this->chunks.at(chunk_pos.as_long());
     chunk.set_tile(((uint16_t)x) % this->chunk_size,
@@ -45,12 +45,14 @@ namespace components {
        private:
         float aspect_ratio;
         float scale;
-        TransformComponent *transform;
+        bool view_uploaded;
+        size_t view_tick;
 
        public:
         CameraComponent(float aspect_ratio, float scale);
         virtual void init(core::Interface &interface);
         virtual void update(core::Interface &interface);
+        virtual void render(core::Interface &interface);
         virtual bool is_unique();
         float get_aspect_ratio();
         float get_scale();
@@ -91,10 +93,26 @@ namespace components {
 
         class TilemapComponent;
 
+        // index range of the baked mesh that uses one texture
+        struct ChunkDraw {
+            render::Texture texture;
+            GLsizei first;
+            GLsizei count;
+        };
+
+        // the tiles of a chunk are baked into a single mesh, which is only
+        // rebuilt after set_tile changed a tile. the chunk owns the mesh, so
+        // it can only be moved.
         class TilemapChunk {
             ChunkPos pos;
             uint16_t chunk_size;
             std::vector<uint16_t> tiles;
+            bool dirty;
+            bool has_mesh;
+            render::Mesh mesh;
+            std::vector<ChunkDraw> draws;
+            void bake(TilemapComponent &tilemap, render::StateCache &state,
+                      float render_size);
 
            public:
             TilemapChunk(ChunkPos pos, uint16_t chunk_size);
@@ -110,15 +128,16 @@ namespace components {
             std::unordered_map<uint16_t, Tile> ids_to_tiles;
             std::unordered_map<Tile, uint16_t, TileHash> tiles_to_ids;
             std::unordered_map<size_t, TilemapChunk> chunks;
-            TransformComponent *cam_transform;
-            CameraComponent *camera;
             ChunkPos get_chunk_pos_from_pos(uint32_t x, uint32_t y);
-            bool should_chunk_render(ChunkPos pos);
+            bool should_chunk_render(ChunkPos pos,
+                                     TransformComponent &cam_transform,
+                                     CameraComponent &camera);
 
            public:
             TilemapComponent(uint16_t chunk_size, float render_tile_size,
                              size_t camera_id);
             virtual void update(core::Interface &interface);
+            virtual void render(core::Interface &interface);
             virtual void init(core::Interface &interface);
             virtual bool is_unique();
             void add_tile_type(Tile tile);
@@ -1,5 +1,6 @@
 #include <asset/asset.h>
 #include <core/core.h>
+#include <core/loop.h>
 #include <render/render.h>
 #include <input/input.h>
 #include <util/timer.h>
@@ -46,7 +47,7 @@ void GenerateWorldComponent::update(core::Interface &interface) {
 void GenerateWorldComponent::init(core::Interface &interface) {
     (void)(interface);
     tilemap::TilemapComponent &tilemap_comp =
-        this->entity->get_single_component<tilemap::TilemapComponent>();
+        this->entity.get_single_component<tilemap::TilemapComponent>();
 
     math::SimplexNoise noise(this->seed);
     for (uint32_t i = 0; i < 0x1000; i++) {
@@ -111,9 +112,9 @@ int main() {
     */
 
     core::Entity camera_entity = game.create_entity();
-    camera_entity.add_component(std::make_unique<comps::TransformComponent>());
-    camera_entity.add_component(
-        std::make_unique<comps::CameraComponent>(1280.0f / 720.0f, 32.0f));
+    camera_entity.add_component<comps::TransformComponent>();
+    camera_entity.add_component<comps::CameraComponent>(1280.0f / 720.0f,
+                                                        32.0f);
     size_t camera_id = camera_entity.get_id();
     game.add_entity(std::move(camera_entity));
 
@@ -127,10 +128,10 @@ int main() {
     tilemap_comp.add_tile_type(stone_tile);
     GenerateWorldComponent generate_comp(12345, grass_tile, dirt_tile,
                                          stone_tile);
-    tilemap_entity.add_component(
-        std::make_unique<tilemap::TilemapComponent>(tilemap_comp));
-    tilemap_entity.add_component(
-        std::make_unique<GenerateWorldComponent>(generate_comp));
+    tilemap_entity.add_component<tilemap::TilemapComponent>(
+        std::move(tilemap_comp));
+    tilemap_entity.add_component<GenerateWorldComponent>(
+        std::move(generate_comp));
     game.add_entity(std::move(tilemap_entity));
 
     core::Interface interface(logger, renderer, time, game);
@@ -139,20 +140,22 @@ int main() {
     size_t frame_count = 0;
     double last_fps_time = 0.0;
     game.init(interface);
-    comps::TransformComponent &camera_tf =
-        game.get_entity(camera_id)
-            .get_single_component<comps::TransformComponent>();
+    core::Loop loop(game, interface, 60.0);
 
     while (window.is_open()) {
         window.poll_inputs();
 
-        renderer.clear();
-
-        game.update(interface);
-        camera_tf.move(10 * (float)time.delta_time(), 0);
-        frame_time_sum += (float)time.delta_time();
-
+        double delta = time.delta_time();
         time._frame_complete();
+        loop.advance(delta);
+        // fetched every frame, the reference would dangle after the next
+        // structural change of the camera's archetype
+        game.get_entity(camera_id)
+            .get_single_component<comps::TransformComponent>()
+            .move(10 * (float)delta, 0);
+        frame_time_sum += (float)delta;
+
+        loop.render();
         window.swap_buffers();
         frame_count++;
         if (time.current() - last_fps_time > 1.0) {
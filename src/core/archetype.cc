@@ -0,0 +1,298 @@
+#include "archetype.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+using namespace core;
+
+namespace {
+    std::atomic<size_t> next_key(0);
+}
+
+size_t core::next_component_key() {
+    size_t key = next_key++;
+    if (key >= MAX_COMPONENT_TYPES)
+        throw std::runtime_error(
+            "reached maximum amount of component types (" +
+            std::to_string(MAX_COMPONENT_TYPES) +
+            "), raise WOODGAS_MAX_COMPONENT_TYPES");
+    return key;
+}
+
+size_t core::get_component_type_count() noexcept {
+    return std::min<size_t>(next_key, MAX_COMPONENT_TYPES);
+}
+
+Column::Column(const ColumnType &type)
+    : type(&type), elements(nullptr), length(0), capacity(0) {}
+
+Column::Column(Column &&other) noexcept
+    : type(other.type),
+      elements(other.elements),
+      length(other.length),
+      capacity(other.capacity),
+      added_ticks(std::move(other.added_ticks)),
+      changed_ticks(std::move(other.changed_ticks)) {
+    other.elements = nullptr;
+    other.length = 0;
+    other.capacity = 0;
+}
+
+void Column::grow(size_t min_capacity) {
+    size_t new_capacity = std::max<size_t>(this->capacity * 2, 8);
+    new_capacity = std::max(new_capacity, min_capacity);
+    // pushing the ticks of a new row can't fail after this
+    this->added_ticks.reserve(new_capacity);
+    this->changed_ticks.reserve(new_capacity);
+    unsigned char *new_data = (unsigned char *)::operator new(
+        new_capacity * this->type->size, std::align_val_t(this->type->align));
+    for (size_t i = 0; i < this->length; i++) {
+        void *src = this->get(i);
+        this->type->move_construct(new_data + i * this->type->size, src);
+        this->type->destroy(src);
+    }
+    if (this->elements) {
+        ::operator delete(this->elements, std::align_val_t(this->type->align));
+    }
+    this->elements = new_data;
+    this->capacity = new_capacity;
+}
+
+const ColumnType &Column::get_type() const noexcept { return *this->type; }
+
+size_t Column::size() const noexcept { return this->length; }
+
+void Column::reserve(size_t capacity) {
+    if (capacity > this->capacity) {
+        this->grow(capacity);
+    }
+}
+
+void *Column::get(size_t row) noexcept {
+    return this->elements + row * this->type->size;
+}
+
+void *Column::data() noexcept { return this->elements; }
+
+const size_t *Column::get_added_ticks() const noexcept {
+    return this->added_ticks.data();
+}
+
+const size_t *Column::get_changed_ticks() const noexcept {
+    return this->changed_ticks.data();
+}
+
+void Column::set_changed(size_t row, size_t tick) noexcept {
+    this->changed_ticks[row] = tick;
+}
+
+void *Column::prepare_push() {
+    if (this->length == this->capacity) {
+        this->grow(this->length + 1);
+    }
+    return this->get(this->length);
+}
+
+void Column::commit_push(size_t tick) noexcept {
+    this->added_ticks.push_back(tick);
+    this->changed_ticks.push_back(tick);
+    this->length++;
+}
+
+void Column::move_row_to(size_t row, Column &other) {
+    void *slot = other.prepare_push();
+    this->type->move_construct(slot, this->get(row));
+    other.commit_push(this->added_ticks[row]);
+    other.changed_ticks.back() = this->changed_ticks[row];
+    this->swap_remove(row);
+}
+
+void Column::swap_remove(size_t row) {
+    size_t last = this->length - 1;
+    this->type->destroy(this->get(row));
+    if (row != last) {
+        this->type->move_construct(this->get(row), this->get(last));
+        this->type->destroy(this->get(last));
+        this->added_ticks[row] = this->added_ticks[last];
+        this->changed_ticks[row] = this->changed_ticks[last];
+    }
+    this->added_ticks.pop_back();
+    this->changed_ticks.pop_back();
+    this->length--;
+}
+
+void Column::init_all(Interface &interface) {
+    this->type->init(this->elements, this->length, interface);
+}
+
+void Column::init_range(size_t begin, size_t count, Interface &interface) {
+    this->type->init(this->get(begin), count, interface);
+}
+
+void Column::update_all(Interface &interface) {
+    this->type->update(this->elements, this->length, interface);
+}
+
+void Column::update_range(size_t begin, size_t count, Interface &interface) {
+    this->type->update(this->get(begin), count, interface);
+}
+
+void Column::render_all(Interface &interface) {
+    this->type->render(this->elements, this->length, interface);
+}
+
+Column::~Column() {
+    if (this->elements) {
+        for (size_t i = 0; i < this->length; i++) {
+            this->type->destroy(this->get(i));
+        }
+        ::operator delete(this->elements, std::align_val_t(this->type->align));
+    }
+}
+
+Archetype::Archetype()
+    : add_edges(MAX_COMPONENT_TYPES, NONE),
+      remove_edges(MAX_COMPONENT_TYPES, NONE) {}
+
+Archetype::Archetype(std::vector<const ColumnType *> types,
+                     const ComponentMask &tags)
+    : Archetype() {
+    std::sort(types.begin(), types.end(),
+              [](const ColumnType *a, const ColumnType *b) {
+                  return a->type_key < b->type_key;
+              });
+    if (!types.empty()) {
+        this->column_indices.resize(types.back()->type_key + 1, NONE);
+    }
+    for (const ColumnType *type : types) {
+        this->column_indices[type->type_key] = this->columns.size();
+        this->signature.push_back(type->type_key);
+        this->mask.set(type->type_key);
+        this->columns.emplace_back(*type);
+    }
+    this->tags = tags;
+    this->mask |= tags;
+}
+
+const std::vector<size_t> &Archetype::get_signature() const noexcept {
+    return this->signature;
+}
+
+const ComponentMask &Archetype::get_mask() const noexcept {
+    return this->mask;
+}
+
+const ComponentMask &Archetype::get_tags() const noexcept {
+    return this->tags;
+}
+
+bool Archetype::has_column(size_t type_key) const noexcept {
+    return type_key < MAX_COMPONENT_TYPES && this->mask.test(type_key) &&
+           !this->tags.test(type_key);
+}
+
+Column &Archetype::get_column(size_t type_key) {
+    if (!this->has_column(type_key))
+        throw std::runtime_error(
+            "Tried to get column of a component type that isn't part of "
+            "the archetype!");
+    return this->columns[this->column_indices[type_key]];
+}
+
+std::vector<Column> &Archetype::get_columns() noexcept {
+    return this->columns;
+}
+
+std::vector<const ColumnType *> Archetype::get_column_types() const {
+    std::vector<const ColumnType *> types;
+    for (const Column &column : this->columns) {
+        types.push_back(&column.get_type());
+    }
+    return types;
+}
+
+size_t Archetype::size() const noexcept { return this->entities.size(); }
+
+void Archetype::reserve(size_t count) {
+    this->entities.reserve(count);
+    for (Column &column : this->columns) {
+        column.reserve(count);
+    }
+}
+
+size_t Archetype::get_entity(size_t row) const noexcept {
+    return this->entities[row];
+}
+
+size_t Archetype::push_entity(size_t entity_id) {
+    this->entities.push_back(entity_id);
+    return this->entities.size() - 1;
+}
+
+size_t Archetype::move_row_to(size_t row, Archetype &other) {
+    for (Column &column : this->columns) {
+        size_t type_key = column.get_type().type_key;
+        if (other.has_column(type_key)) {
+            column.move_row_to(row, other.get_column(type_key));
+        } else {
+            column.swap_remove(row);
+        }
+    }
+    size_t new_row = other.push_entity(this->entities[row]);
+    this->entities[row] = this->entities.back();
+    this->entities.pop_back();
+    return new_row;
+}
+
+bool Archetype::remove_row(size_t row) {
+    for (Column &column : this->columns) {
+        column.swap_remove(row);
+    }
+    this->entities[row] = this->entities.back();
+    this->entities.pop_back();
+    return row < this->entities.size();
+}
+
+bool Archetype::find_edge(size_t type_key, bool add, size_t &archetype) const {
+    size_t edge =
+        add ? this->add_edges[type_key] : this->remove_edges[type_key];
+    if (edge == NONE) {
+        return false;
+    }
+    archetype = edge;
+    return true;
+}
+
+void Archetype::set_edge(size_t type_key, bool add, size_t archetype) {
+    if (add) {
+        this->add_edges[type_key] = archetype;
+    } else {
+        this->remove_edges[type_key] = archetype;
+    }
+}
+
+void Archetype::init(Interface &interface) {
+    for (Column &column : this->columns) {
+        column.init_all(interface);
+    }
+}
+
+void Archetype::update(Interface &interface, const ComponentMask &skip,
+                       Profiler &profiler) {
+    for (Column &column : this->columns) {
+        if (!skip.test(column.get_type().type_key)) {
+            ProfileScope scope(profiler, column.get_type(), column.size());
+            column.update_all(interface);
+        }
+    }
+}
+
+void Archetype::render(Interface &interface) {
+    for (Column &column : this->columns) {
+        column.render_all(interface);
+    }
+}
@@ -0,0 +1,231 @@
+// header for archetype based component storage
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace core {
+    class Component;
+    class Interface;
+    class Profiler;
+
+    // type-erased description of what is stored in a column. unique
+    // components are stored inline, non-unique ones as a std::vector<T> per
+    // row so an entity can hold several of them. the dynamic type of every
+    // element is exactly T, so init/update/render loop over a whole column
+    // without a virtual call per component.
+    struct ColumnType {
+        size_t type_key;
+        const char *name;
+        bool unique;
+        size_t size;
+        size_t align;
+        void (*move_construct)(void *dst, void *src);
+        void (*destroy)(void *ptr);
+        void (*init)(void *data, size_t count, Interface &interface);
+        void (*update)(void *data, size_t count, Interface &interface);
+        void (*render)(void *data, size_t count, Interface &interface);
+    };
+
+#ifndef WOODGAS_MAX_COMPONENT_TYPES
+#define WOODGAS_MAX_COMPONENT_TYPES 128
+#endif
+
+    // shared by every game of the process, set at build time through
+    // WOODGAS_MAX_COMPONENT_TYPES
+    const size_t MAX_COMPONENT_TYPES = WOODGAS_MAX_COMPONENT_TYPES;
+
+    typedef std::bitset<MAX_COMPONENT_TYPES> ComponentMask;
+
+    size_t next_component_key();
+    size_t get_component_type_count() noexcept;
+
+    // small dense integer per component type (and tag), handed out by a
+    // process-wide counter the first time the type is used. keys index
+    // straight into archetype lookup tables and component masks.
+    // first-use order depends on the code that runs, so without
+    // register_components keys may differ between runs and executables;
+    // nothing that outlives the process (snapshots) stores them. the
+    // counter is shared by all games and plugins of a process and throws
+    // once MAX_COMPONENT_TYPES keys are handed out, which happens wherever
+    // the next new type is first used, possibly in the middle of a frame.
+    template <class T>
+    inline size_t unqualified_component_key() {
+        static const size_t key = next_component_key();
+        return key;
+    }
+
+    template <class T>
+    inline size_t component_key() {
+        return unqualified_component_key<typename std::remove_cv<T>::type>();
+    }
+
+    // hands out the keys of Ts in the listed order. called at startup,
+    // before anything else uses one of the types, it makes the keys the
+    // same in every run and executable registering the same list, and
+    // running out of keys fails there instead of during a frame.
+    template <class... Ts>
+    void register_components();
+
+    template <class T>
+    const ColumnType &column_type(bool unique);
+
+    // contiguous, type-homogeneous array holding one element per row.
+    // next to every element the column keeps the game ticks at which it was
+    // added and last marked as changed.
+    class Column {
+        const ColumnType *type;
+        unsigned char *elements;
+        size_t length;
+        size_t capacity;
+        std::vector<size_t> added_ticks;
+        std::vector<size_t> changed_ticks;
+        void grow(size_t min_capacity);
+
+       public:
+        explicit Column(const ColumnType &type);
+        Column(Column &&other) noexcept;
+        Column(const Column &other) = delete;
+        const ColumnType &get_type() const noexcept;
+        size_t size() const noexcept;
+        void reserve(size_t capacity);
+        void *get(size_t row) noexcept;
+        void *data() noexcept;
+        const size_t *get_added_ticks() const noexcept;
+        const size_t *get_changed_ticks() const noexcept;
+        void set_changed(size_t row, size_t tick) noexcept;
+        void *prepare_push();
+        void commit_push(size_t tick) noexcept;
+        void move_row_to(size_t row, Column &other);
+        void swap_remove(size_t row);
+        void init_all(Interface &interface);
+        void init_range(size_t begin, size_t count, Interface &interface);
+        void update_all(Interface &interface);
+        void update_range(size_t begin, size_t count, Interface &interface);
+        void render_all(Interface &interface);
+        ~Column();
+    };
+
+    // all entities sharing the exact same set of component types and tags.
+    // columns are found through a table indexed by component key, tags are
+    // only part of the mask and take no storage at all.
+    class Archetype {
+        static constexpr size_t NONE = (size_t)-1;
+
+        std::vector<size_t> signature;
+        ComponentMask mask;
+        ComponentMask tags;
+        std::vector<Column> columns;
+        std::vector<size_t> column_indices;
+        std::vector<size_t> entities;
+        std::vector<size_t> add_edges;
+        std::vector<size_t> remove_edges;
+
+       public:
+        Archetype();
+        explicit Archetype(std::vector<const ColumnType *> types,
+                           const ComponentMask &tags = ComponentMask());
+        const std::vector<size_t> &get_signature() const noexcept;
+        const ComponentMask &get_mask() const noexcept;
+        const ComponentMask &get_tags() const noexcept;
+        bool has_column(size_t type_key) const noexcept;
+        Column &get_column(size_t type_key);
+        std::vector<Column> &get_columns() noexcept;
+        std::vector<const ColumnType *> get_column_types() const;
+        size_t size() const noexcept;
+        void reserve(size_t count);
+        size_t get_entity(size_t row) const noexcept;
+        size_t push_entity(size_t entity_id);
+        size_t move_row_to(size_t row, Archetype &other);
+        bool remove_row(size_t row);
+        bool find_edge(size_t type_key, bool add, size_t &archetype) const;
+        void set_edge(size_t type_key, bool add, size_t archetype);
+        void init(Interface &interface);
+        void update(Interface &interface, const ComponentMask &skip,
+                    Profiler &profiler);
+        void render(Interface &interface);
+    };
+}
+
+template <class T>
+const core::ColumnType &core::column_type(bool unique) {
+    static const ColumnType inline_type{
+        component_key<T>(),
+        typeid(T).name(),
+        true,
+        sizeof(T),
+        alignof(T),
+        [](void *dst, void *src) { new (dst) T(std::move(*(T *)src)); },
+        [](void *ptr) { ((T *)ptr)->~T(); },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                ((T *)data)[i].T::init(interface);
+            }
+        },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                ((T *)data)[i].T::update(interface);
+            }
+        },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                ((T *)data)[i].T::render(interface);
+            }
+        },
+    };
+    using Multi = std::vector<T>;
+    static const ColumnType multi_type{
+        component_key<T>(),
+        typeid(T).name(),
+        false,
+        sizeof(Multi),
+        alignof(Multi),
+        [](void *dst, void *src) {
+            new (dst) Multi(std::move(*(Multi *)src));
+        },
+        [](void *ptr) { ((Multi *)ptr)->~Multi(); },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                for (T &component : ((Multi *)data)[i]) {
+                    component.T::init(interface);
+                }
+            }
+        },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                for (T &component : ((Multi *)data)[i]) {
+                    component.T::update(interface);
+                }
+            }
+        },
+        [](void *data, size_t count, Interface &interface) {
+            for (size_t i = 0; i < count; i++) {
+                for (T &component : ((Multi *)data)[i]) {
+                    component.T::render(interface);
+                }
+            }
+        },
+    };
+    return unique ? inline_type : multi_type;
+}
+
+template <class... Ts>
+void core::register_components() {
+    // registering the same list again is fine, as long as the keys still
+    // follow each other in the listed order
+    size_t keys[] = {0, component_key<Ts>()...};
+    for (size_t i = 2; i < sizeof(keys) / sizeof(size_t); i++) {
+        if (keys[i] != keys[1] + i - 1)
+            throw std::runtime_error(
+                "Tried to register the component types in a fixed order, "
+                "but some of them were already used in another order!");
+    }
+}
@@ -0,0 +1,178 @@
+#include "commands.h"
+
+#include <algorithm>
+
+using namespace core;
+
+Commands::PendingComponent::~PendingComponent() {}
+
+Commands::Commands() : pending_count(0), epoch(0), applied_epoch(0) {}
+
+bool Commands::is_pending(size_t entity_id) noexcept {
+    return entity_id & PENDING;
+}
+
+void Commands::push(Command command) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    command.sequence = this->commands.size();
+    this->commands.push_back(command);
+}
+
+Pool &Commands::get_pool(size_t size, size_t align) {
+    // pending components of the same size and alignment share a pool
+    std::pair<size_t, size_t> key(size, align);
+    auto it = this->pools.find(key);
+    if (it == this->pools.end()) {
+        it = this->pools.insert({key, std::make_unique<Pool>(size, align)})
+                 .first;
+    }
+    return *it->second;
+}
+
+void Commands::release(Command &command) noexcept {
+    if (command.component) {
+        command.component->~PendingComponent();
+        command.pool->deallocate(command.component);
+        command.component = nullptr;
+    }
+}
+
+size_t Commands::create_entity() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size_t entity_id = PENDING | (this->epoch & EPOCH_MASK) << 32 |
+                       this->pending_count++;
+    this->commands.push_back(Command{CREATE, this->commands.size(), entity_id,
+                                     0, nullptr, nullptr, nullptr, nullptr});
+    return entity_id;
+}
+
+void Commands::instantiate(const Prefab &prefab, size_t count) {
+    // the prefab has to stay alive until the buffer is applied
+    this->push(
+        Command{CREATE, 0, 0, count, nullptr, nullptr, nullptr, &prefab});
+}
+
+void Commands::destroy_entity(size_t entity_id) {
+    this->push(Command{DESTROY, 0, entity_id, 0, nullptr, nullptr, nullptr,
+                       nullptr});
+}
+
+void Commands::set_active(size_t entity_id, bool state) {
+    void (*change)(Game &game, size_t entity_id);
+    if (state) {
+        change = [](Game &game, size_t entity_id) {
+            game.set_active(entity_id, true);
+        };
+    } else {
+        change = [](Game &game, size_t entity_id) {
+            game.set_active(entity_id, false);
+        };
+    }
+    this->push(
+        Command{CHANGE, 0, entity_id, 0, nullptr, nullptr, change, nullptr});
+}
+
+void Commands::set_parent(size_t entity_id, size_t parent_id) {
+    this->push(Command{REPARENT, 0, entity_id, parent_id, nullptr, nullptr,
+                       nullptr, nullptr});
+}
+
+size_t Commands::size() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->commands.size();
+}
+
+size_t Commands::resolve(size_t entity_id) {
+    if (!is_pending(entity_id)) {
+        return entity_id;
+    }
+    size_t index = entity_index(entity_id);
+    size_t epoch = (entity_id >> 32) & EPOCH_MASK;
+    if (epoch != (this->applied_epoch & EPOCH_MASK) ||
+        index >= this->created.size())
+        throw std::runtime_error("Tried to use pending entity " +
+                                 std::to_string(index) +
+                                 ", but it wasn't created by this buffer!");
+    return this->created[index];
+}
+
+void Commands::apply(Game &game) {
+    size_t created_count;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        // both buffers keep their capacity, so recording the next frame
+        // doesn't have to allocate again
+        this->batch.swap(this->commands);
+        created_count = this->pending_count;
+        this->pending_count = 0;
+        // ids recorded from now on belong to the next batch
+        this->applied_epoch = this->epoch++;
+    }
+    if (this->batch.empty()) {
+        return;
+    }
+    // group the changes of every entity together and run all creations
+    // before and all destructions after everything else. changes to the
+    // same entity keep the order they were recorded in.
+    std::sort(this->batch.begin(), this->batch.end(),
+              [](const Command &a, const Command &b) {
+                  if (a.phase != b.phase) {
+                      return a.phase < b.phase;
+                  }
+                  if (entity_index(a.entity) != entity_index(b.entity)) {
+                      return entity_index(a.entity) < entity_index(b.entity);
+                  }
+                  return a.sequence < b.sequence;
+              });
+    this->created.assign(created_count, 0);
+    game.reserve_entities(created_count);
+    size_t i = 0;
+    try {
+        for (; i < this->batch.size(); i++) {
+            Command &command = this->batch[i];
+            switch (command.phase) {
+                case CREATE:
+                    if (command.prefab) {
+                        game.instantiate(*command.prefab, command.other);
+                    } else {
+                        this->created[entity_index(command.entity)] =
+                            game.create_entity().get_id();
+                    }
+                    break;
+                case CHANGE:
+                    if (command.component) {
+                        command.component->add(game,
+                                               this->resolve(command.entity));
+                        this->release(command);
+                    } else {
+                        command.change(game, this->resolve(command.entity));
+                    }
+                    break;
+                case REPARENT:
+                    game.set_parent(this->resolve(command.entity),
+                                    this->resolve(command.other));
+                    break;
+                case DESTROY: {
+                    size_t entity_id = this->resolve(command.entity);
+                    if (game.has_entity(entity_id)) {
+                        game.destroy_entity(entity_id);
+                    }
+                    break;
+                }
+            }
+        }
+    } catch (...) {
+        for (; i < this->batch.size(); i++) {
+            this->release(this->batch[i]);
+        }
+        this->batch.clear();
+        throw;
+    }
+    this->batch.clear();
+}
+
+Commands::~Commands() {
+    for (Command &command : this->commands) {
+        this->release(command);
+    }
+}
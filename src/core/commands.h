@@ -0,0 +1,185 @@
+// header for deferred structural changes
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+#include "pool.h"
+
+namespace core {
+    // records structural changes during init/update and applies them when
+    // the game reaches its next sync point. recording is thread-safe, so
+    // concurrently running systems can share one buffer. entities created
+    // through the buffer are referred to by pending ids until then. a
+    // pending id only stays valid until the buffer it was recorded into is
+    // applied, using it in a later buffer throws.
+    // pending components live in pools owned by the buffer, so recording
+    // and applying reuses memory from earlier frames.
+    class Commands {
+        // pending ids hold the epoch of the buffer in bits 32-62 and the
+        // index of the creation in the low 32 bits
+        static constexpr size_t PENDING = (size_t)1 << 63;
+        static constexpr size_t EPOCH_MASK = 0x7FFFFFFF;
+
+        enum Phase { CREATE, CHANGE, REPARENT, DESTROY };
+
+        class PendingComponent {
+           public:
+            virtual void add(Game &game, size_t entity_id) = 0;
+            virtual ~PendingComponent();
+        };
+
+        template <class T>
+        class OwnedPendingComponent : public PendingComponent {
+            std::unique_ptr<T> component;
+
+           public:
+            OwnedPendingComponent(std::unique_ptr<T> component);
+            virtual void add(Game &game, size_t entity_id);
+        };
+
+        template <class T>
+        class EmplacedPendingComponent : public PendingComponent {
+            T component;
+
+           public:
+            template <class... Args>
+            EmplacedPendingComponent(Args &&... args);
+            virtual void add(Game &game, size_t entity_id);
+        };
+
+        struct Command {
+            Phase phase;
+            size_t sequence;
+            size_t entity;
+            size_t other;
+            PendingComponent *component;
+            Pool *pool;
+            void (*change)(Game &game, size_t entity_id);
+            const Prefab *prefab;
+        };
+
+        std::vector<Command> commands;
+        std::vector<Command> batch;
+        std::vector<size_t> created;
+        std::map<std::pair<size_t, size_t>, std::unique_ptr<Pool>> pools;
+        size_t pending_count;
+        size_t epoch;
+        size_t applied_epoch;
+        std::mutex mutex;
+        void push(Command command);
+        Pool &get_pool(size_t size, size_t align);
+        template <class P, class... Args>
+        void push_component(size_t entity_id, Args &&... args);
+        void release(Command &command) noexcept;
+        size_t resolve(size_t entity_id);
+
+       public:
+        Commands();
+        static bool is_pending(size_t entity_id) noexcept;
+        size_t create_entity();
+        void instantiate(const Prefab &prefab, size_t count);
+        void destroy_entity(size_t entity_id);
+        template <class T>
+        inline void add_component(size_t entity_id,
+                                  std::unique_ptr<T> component);
+        template <class T, class... Args>
+        inline void emplace_component(size_t entity_id, Args &&... args);
+        template <class T>
+        inline void remove_component(size_t entity_id);
+        template <class T>
+        inline void add_tag(size_t entity_id);
+        template <class T>
+        inline void remove_tag(size_t entity_id);
+        void set_active(size_t entity_id, bool state);
+        void set_parent(size_t entity_id, size_t parent_id);
+        size_t size() noexcept;
+        void apply(Game &game);
+        ~Commands();
+    };
+}
+
+template <class T>
+core::Commands::OwnedPendingComponent<T>::OwnedPendingComponent(
+    std::unique_ptr<T> component)
+    : component(std::move(component)) {}
+
+template <class T>
+void core::Commands::OwnedPendingComponent<T>::add(Game &game,
+                                                   size_t entity_id) {
+    game.add_component<T>(entity_id, std::move(this->component));
+}
+
+template <class T>
+template <class... Args>
+core::Commands::EmplacedPendingComponent<T>::EmplacedPendingComponent(
+    Args &&... args)
+    : component(std::forward<Args>(args)...) {}
+
+template <class T>
+void core::Commands::EmplacedPendingComponent<T>::add(Game &game,
+                                                      size_t entity_id) {
+    game.emplace_component<T>(entity_id, std::move(this->component));
+}
+
+template <class P, class... Args>
+void core::Commands::push_component(size_t entity_id, Args &&... args) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Pool &pool = this->get_pool(sizeof(P), alignof(P));
+    void *block = pool.allocate();
+    P *component;
+    try {
+        component = new (block) P(std::forward<Args>(args)...);
+    } catch (...) {
+        pool.deallocate(block);
+        throw;
+    }
+    this->commands.push_back(Command{CHANGE, this->commands.size(), entity_id,
+                                     0, component, &pool, nullptr, nullptr});
+}
+
+template <class T>
+void core::Commands::add_component(size_t entity_id,
+                                   std::unique_ptr<T> component) {
+    this->push_component<OwnedPendingComponent<T>>(entity_id,
+                                                   std::move(component));
+}
+
+template <class T, class... Args>
+void core::Commands::emplace_component(size_t entity_id, Args &&... args) {
+    this->push_component<EmplacedPendingComponent<T>>(
+        entity_id, std::forward<Args>(args)...);
+}
+
+template <class T>
+void core::Commands::remove_component(size_t entity_id) {
+    this->push(Command{CHANGE, 0, entity_id, 0, nullptr, nullptr,
+                       [](Game &game, size_t entity_id) {
+                           game.remove_component<T>(entity_id);
+                       },
+                       nullptr});
+}
+
+template <class T>
+void core::Commands::add_tag(size_t entity_id) {
+    this->push(Command{CHANGE, 0, entity_id, 0, nullptr, nullptr,
+                       [](Game &game, size_t entity_id) {
+                           game.add_tag<T>(entity_id);
+                       },
+                       nullptr});
+}
+
+template <class T>
+void core::Commands::remove_tag(size_t entity_id) {
+    this->push(Command{CHANGE, 0, entity_id, 0, nullptr, nullptr,
+                       [](Game &game, size_t entity_id) {
+                           game.remove_tag<T>(entity_id);
+                       },
+                       nullptr});
+}
@@ -1,13 +1,35 @@
 #include "core.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
 using namespace core;
 
 Interface::Interface()
-    : logger(nullptr), renderer(nullptr), time(nullptr), game(nullptr) {}
+    : logger(nullptr),
+      renderer(nullptr),
+      time(nullptr),
+      game(nullptr),
+      tick_length(0),
+      alpha(1) {}
 
 Interface::Interface(logging::Logger& logger, render::Renderer& renderer,
                      timer::Time& time, Game& game)
-    : logger(&logger), renderer(&renderer), time(&time), game(&game) {}
+    : logger(&logger),
+      renderer(&renderer),
+      time(&time),
+      game(&game),
+      tick_length(0),
+      alpha(1) {}
+
+Interface::Interface(logging::Logger& logger, timer::Time& time, Game& game)
+    : logger(&logger),
+      renderer(nullptr),
+      time(&time),
+      game(&game),
+      tick_length(0),
+      alpha(1) {}
 
 render::Renderer& Interface::get_renderer() { return *this->renderer; }
 
@@ -25,50 +47,86 @@ Game& Interface::get_game() { return *this->game; }
 
 bool Interface::has_game() { return this->game; }
 
-Component::Component() : enabled(true), entity(nullptr) {}
+double Interface::get_tick_length() { return this->tick_length; }
+
+float Interface::get_alpha() { return this->alpha; }
+
+void Interface::_set_tick(double tick_length, float alpha) {
+    this->tick_length = tick_length;
+    this->alpha = alpha;
+}
+
+Component::Component() : enabled(true) {}
 
 bool Component::is_enabled() { return this->enabled; }
 
 void Component::set_active(bool state) { this->enabled = state; }
 
-void Component::set_entity(Entity& entity) { this->entity = &entity; }
+void Component::set_entity(Entity entity) { this->entity = entity; }
 
 Component::~Component() {}
 
-Entity::Entity(size_t id) : id(id), enabled(true), parent(nullptr) {}
+System::System() : last_run_tick(0) {}
 
-Entity::Entity(Entity&& other)
-    : id(other.id),
-      enabled(other.enabled),
-      components(std::move(other.components)),
-      children(std::move(other.children)),
-      parent(other.parent) {
-    for (auto& components : this->components) {
-        for (auto& component : components.second) {
-            component->set_entity(*this);
-        }
-    }
+void System::render(Game& game, Interface& interface) {
+    (void)(game);
+    (void)(interface);
+}
+
+Access System::get_access() { return Access(); }
+
+size_t System::get_last_run_tick() const noexcept {
+    return this->last_run_tick;
 }
 
-bool Entity::is_enabled() { return this->enabled; }
+void System::_set_last_run_tick(size_t tick) noexcept {
+    this->last_run_tick = tick;
+}
+
+System::~System() {}
+
+namespace {
+    // the system update running on this thread, if any
+    struct RunningSystem {
+        const Game* game;
+        size_t tick;
+        size_t since;
+    };
+    thread_local RunningSystem running_system{nullptr, 0, 0};
+}
+
+SystemScope::SystemScope(Game& game, System& system, size_t tick)
+    : game(game), system(system), tick(tick) {
+    // a first run sees everything, including what was made before tick 1
+    size_t last = system.get_last_run_tick();
+    running_system = RunningSystem{&game, tick, last == 0 ? 0 : last + 1};
+}
+
+SystemScope::~SystemScope() {
+    running_system = RunningSystem{nullptr, 0, 0};
+    this->system._set_last_run_tick(this->tick);
+}
+
+Entity::Entity() : game(nullptr), id(0) {}
+
+Entity::Entity(Game& game, size_t id) : game(&game), id(id) {}
 
-void Entity::set_active(bool state) { this->enabled = state; }
+bool Entity::is_enabled() { return this->game->is_enabled(this->id); }
+
+void Entity::set_active(bool state) {
+    this->game->set_active(this->id, state);
+}
 
 void Entity::add_child(Entity entity) {
-    if (this->has_child(entity.get_id()))
-        throw std::runtime_error("Tried to add children with the id " +
-                                 std::to_string(entity.get_id()) +
-                                 ", but it already exists!");
-    entity.parent = this;
-    this->children.insert(std::make_pair(entity.get_id(), std::move(entity)));
+    this->game->add_child(this->id, entity.get_id());
 }
 
-Entity& Entity::get_child(size_t entity_id) {
+Entity Entity::get_child(size_t entity_id) {
     if (!this->has_child(entity_id))
         throw std::runtime_error("Tried to get children with id " +
                                  std::to_string(entity_id) +
                                  ", but it doesn't exist!");
-    return this->children.at(entity_id);
+    return Entity(*this->game, entity_id);
 }
 
 void Entity::destroy_child(size_t entity_id) {
@@ -76,110 +134,655 @@ void Entity::destroy_child(size_t entity_id) {
         throw std::runtime_error("Tried to destroy children with id " +
                                  std::to_string(entity_id) +
                                  ", but it doesn't exist!");
-    this->children.erase(entity_id);
+    this->game->destroy_entity(entity_id);
 }
 
 bool Entity::has_child(size_t entity_id) noexcept {
-    return this->children.find(entity_id) != this->children.end();
+    return this->game->has_child(this->id, entity_id);
 }
 
-bool Entity::has_parent() noexcept { return this->parent; }
+bool Entity::has_parent() noexcept { return this->game->has_parent(this->id); }
 
 size_t Entity::get_id() noexcept { return this->id; }
 
-Entity& Entity::get_parent() {
+Entity Entity::get_parent() {
     if (!this->has_parent())
         throw std::runtime_error(
             "Tried to get parent of entity, but entity has no parent!");
-    return *this->parent;
-}
-
-void Entity::add_component(std::unique_ptr<Component> component) {
-    component->set_entity(*this);
-    if (this->components.find(typeid(*component).hash_code()) ==
-        this->components.end()) {
-        std::vector<std::unique_ptr<Component>> comp_vec;
-        comp_vec.push_back(std::move(component));
-        this->components.insert(std::make_pair(
-            typeid(*comp_vec.at(0)).hash_code(), std::move(comp_vec)));
-    } else if (!(*component).is_unique()) {
-        this->components.at(typeid(*component).hash_code())
-            .push_back(std::move(component));
-    } else {
-        throw std::runtime_error("Tried to add unique Component " +
-                                 std::string(typeid(*component).name()) +
-                                 " twice!");
-    }
+    return Entity(*this->game, this->game->get_parent(this->id));
 }
 
-void Entity::init(Interface& interface) {
-    for (auto& components : this->components) {
-        for (auto& component : components.second) {
-            component->init(interface);
-        }
+namespace {
+    // structural changes move rows between archetypes, which would pull
+    // components out from under a running init/update loop
+    class LockGuard {
+        bool& locked;
+
+       public:
+        LockGuard(bool& locked) : locked(locked) { this->locked = true; }
+        ~LockGuard() { this->locked = false; }
+    };
+}
+
+Game::Game() : Game(threading::default_worker_count()) {}
+
+Game::Game(size_t worker_count)
+    : locked(false),
+      tick(0),
+      update_tick(0),
+      last_update_tick(0),
+      structure_version(0),
+      hierarchy_version((size_t)-1),
+      update_policies(MAX_COMPONENT_TYPES,
+                      UpdatePolicy{0, 1, HIGH_PRIORITY, 0, 0}),
+      init_policies(MAX_COMPONENT_TYPES, InitPolicy{false, 0, {}}),
+      init_policies_used(false),
+      frame_budget(0),
+      last_update_time(0),
+      deferred_updates(0),
+      scheduler(worker_count),
+      commands(std::make_unique<Commands>()) {
+    this->archetypes.push_back(std::make_unique<Archetype>());
+    this->archetype_ids.insert({ComponentMask(), 0});
+}
+
+EntityRecord& Game::get_record(size_t entity_id) {
+    return this->entities.get(entity_id);
+}
+
+void Game::check_unlocked(const char* action) {
+    if (this->locked)
+        throw std::runtime_error(
+            "Tried to " + std::string(action) +
+            " while the game is updating! Record it through "
+            "Game::get_commands() instead.");
+}
+
+size_t Game::find_archetype(size_t source, size_t type_key,
+                            const ColumnType* type, bool add) {
+    // type is null for tags, which only change the mask
+    size_t target;
+    if (this->archetypes[source]->find_edge(type_key, add, target)) {
+        return target;
+    }
+    std::vector<const ColumnType*> types =
+        this->archetypes[source]->get_column_types();
+    ComponentMask tags = this->archetypes[source]->get_tags();
+    if (!type) {
+        tags.set(type_key, add);
+    } else if (add) {
+        types.push_back(type);
+    } else {
+        types.erase(std::find(types.begin(), types.end(), type));
     }
-    for (auto& child : this->children) {
-        child.second.init(interface);
+    ComponentMask mask = this->archetypes[source]->get_mask();
+    mask.set(type_key, add);
+    auto it = this->archetype_ids.find(mask);
+    if (it != this->archetype_ids.end()) {
+        target = it->second;
+    } else {
+        target = this->archetypes.size();
+        this->archetypes.push_back(std::make_unique<Archetype>(types, tags));
+        this->archetype_ids.insert({mask, target});
     }
+    this->archetypes[source]->set_edge(type_key, add, target);
+    return target;
 }
 
-void Entity::update(Interface& interface) {
-    for (auto& components : this->components) {
-        for (auto& component : components.second) {
-            component->update(interface);
-        }
+size_t Game::find_archetype(std::vector<const ColumnType*> types,
+                            const ComponentMask& tags) {
+    ComponentMask mask = tags;
+    for (const ColumnType* type : types) {
+        mask.set(type->type_key);
     }
-    for (auto& child : this->children) {
-        child.second.update(interface);
+    auto it = this->archetype_ids.find(mask);
+    if (it != this->archetype_ids.end()) {
+        return it->second;
     }
+    size_t archetype = this->archetypes.size();
+    this->archetypes.push_back(
+        std::make_unique<Archetype>(std::move(types), tags));
+    this->archetype_ids.insert({mask, archetype});
+    return archetype;
 }
 
-Entity::~Entity() {}
-
-Game::Game() : entity_id(0) {}
+void Game::move_entity(EntityRecord& record, size_t archetype) {
+    Archetype& source = *this->archetypes[record.archetype];
+    size_t row = record.row;
+    record.row = source.move_row_to(row, *this->archetypes[archetype]);
+    record.archetype = archetype;
+    record.mask = this->archetypes[archetype]->get_mask();
+    this->structure_version++;
+    if (row < source.size()) {
+        this->entities.get(source.get_entity(row)).row = row;
+    }
+}
 
-size_t Game::next_id() { return this->entity_id++; }
+Entity Game::create_entity() {
+    this->check_unlocked("create an entity");
+    this->structure_version++;
+    size_t id = this->entities.create();
+    this->entities.get(id).row = this->archetypes[0]->push_entity(id);
+    return Entity(*this, id);
+}
 
-Entity Game::create_entity() { return std::move(Entity{this->next_id()}); }
+std::vector<Entity> Game::instantiate(const Prefab& prefab, size_t count) {
+    this->check_unlocked("instantiate a prefab");
+    std::vector<const ColumnType*> types;
+    for (auto& prototypes : prefab.prototypes) {
+        types.push_back(&prototypes->get_column_type());
+    }
+    size_t target = this->find_archetype(types, prefab.tags);
+    Archetype& archetype = *this->archetypes[target];
+    for (const ColumnType* type : types) {
+        if (!archetype.has_column(type->type_key) ||
+            &archetype.get_column(type->type_key).get_type() != type)
+            throw std::runtime_error(
+                "Tried to instantiate Component " + std::string(type->name) +
+                ", but it's stored differently in this game!");
+    }
+    this->entities.reserve(count);
+    archetype.reserve(archetype.size() + count);
+    std::vector<size_t> ids(count);
+    for (size_t& id : ids) {
+        id = this->entities.create();
+    }
+    // fill the columns first, so that a throwing copy can be rolled back
+    // before any entity was added to the archetype
+    size_t rows = archetype.size();
+    try {
+        for (size_t i = 0; i < prefab.prototypes.size(); i++) {
+            prefab.prototypes[i]->instantiate(
+                archetype.get_column(prefab.type_keys[i]), *this, ids.data(),
+                count, this->tick);
+        }
+    } catch (...) {
+        for (Column& column : archetype.get_columns()) {
+            while (column.size() > rows) {
+                column.swap_remove(column.size() - 1);
+            }
+        }
+        for (size_t id : ids) {
+            this->entities.destroy(id);
+        }
+        throw;
+    }
+    std::vector<Entity> instances;
+    instances.reserve(count);
+    for (size_t id : ids) {
+        EntityRecord& record = this->entities.get(id);
+        record.archetype = target;
+        record.row = archetype.push_entity(id);
+        record.mask = archetype.get_mask();
+        instances.push_back(Entity(*this, id));
+    }
+    this->structure_version++;
+    return instances;
+}
 
 void Game::add_entity(Entity entity) {
-    if (this->has_entity(entity.get_id()))
+    EntityRecord& record = this->get_record(entity.get_id());
+    if (record.root || record.has_parent)
         throw std::runtime_error("Tried to add an entity with the id " +
                                  std::to_string(entity.get_id()) +
                                  ", but it already exists!");
-    this->entities.insert(std::make_pair(entity.get_id(), std::move(entity)));
+    record.root = true;
 }
 
-Entity& Game::get_entity(size_t entity_id) {
-    if (!this->has_entity(entity_id))
-        throw std::runtime_error("Tried to get entity with id " +
-                                 std::to_string(entity_id) +
-                                 ", but it doesn't exist!");
-    return this->entities.at(entity_id);
+Entity Game::get_entity(size_t entity_id) {
+    this->get_record(entity_id);
+    return Entity(*this, entity_id);
+}
+
+void Game::remove_entity(size_t entity_id) {
+    this->structure_version++;
+    EntityRecord& record = this->entities.get(entity_id);
+    while (!record.children.empty()) {
+        size_t child = record.children.back();
+        record.children.pop_back();
+        this->remove_entity(child);
+    }
+    Archetype& archetype = *this->archetypes[record.archetype];
+    if (archetype.remove_row(record.row)) {
+        this->entities.get(archetype.get_entity(record.row)).row = record.row;
+    }
+    this->entities.destroy(entity_id);
 }
 
 void Game::destroy_entity(size_t entity_id) {
+    this->check_unlocked("destroy an entity");
     if (!this->has_entity(entity_id))
         throw std::runtime_error("Tried to destroy the entity with id " +
                                  std::to_string(entity_id) +
                                  ", but it doesn't exist!");
-    this->entities.erase(entity_id);
+    EntityRecord& record = this->entities.get(entity_id);
+    if (record.has_parent) {
+        std::vector<size_t>& siblings =
+            this->entities.get(record.parent).children;
+        siblings.erase(
+            std::find(siblings.begin(), siblings.end(), entity_id));
+    }
+    this->remove_entity(entity_id);
 }
 
 bool Game::has_entity(size_t entity_id) noexcept {
-    return this->entities.find(entity_id) != this->entities.end();
+    return this->entities.contains(entity_id);
+}
+
+bool Game::is_enabled(size_t entity_id) {
+    return !this->get_record(entity_id).mask.test(component_key<Disabled>());
+}
+
+void Game::set_active(size_t entity_id, bool state) {
+    this->set_tag(entity_id, component_key<Disabled>(), !state);
+}
+
+void Game::set_tag(size_t entity_id, size_t tag_key, bool state) {
+    this->check_unlocked("change the tags of an entity");
+    EntityRecord& record = this->get_record(entity_id);
+    if (record.mask.test(tag_key) == state) {
+        return;
+    }
+    size_t target =
+        this->find_archetype(record.archetype, tag_key, nullptr, state);
+    this->move_entity(record, target);
+}
+
+void Game::add_child(size_t parent_id, size_t child_id) {
+    this->check_unlocked("add a child");
+    EntityRecord& child = this->get_record(child_id);
+    EntityRecord& parent = this->get_record(parent_id);
+    if (child.root || child.has_parent || parent_id == child_id)
+        throw std::runtime_error("Tried to add children with the id " +
+                                 std::to_string(child_id) +
+                                 ", but it already exists!");
+    child.has_parent = true;
+    child.parent = parent_id;
+    parent.children.push_back(child_id);
+    this->structure_version++;
+}
+
+void Game::set_parent(size_t entity_id, size_t parent_id) {
+    this->check_unlocked("reparent an entity");
+    EntityRecord& child = this->get_record(entity_id);
+    for (size_t ancestor = parent_id;;) {
+        if (ancestor == entity_id)
+            throw std::runtime_error("Tried to make entity " +
+                                     std::to_string(entity_id) +
+                                     " a descendant of itself!");
+        EntityRecord& record = this->get_record(ancestor);
+        if (!record.has_parent) {
+            break;
+        }
+        ancestor = record.parent;
+    }
+    if (child.has_parent) {
+        std::vector<size_t>& siblings =
+            this->entities.get(child.parent).children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), entity_id));
+    }
+    child.root = false;
+    child.has_parent = true;
+    child.parent = parent_id;
+    this->get_record(parent_id).children.push_back(entity_id);
+    this->structure_version++;
+}
+
+void Game::reserve_entities(size_t count) {
+    this->entities.reserve(count);
+    Archetype& empty = *this->archetypes[0];
+    empty.reserve(empty.size() + count);
+}
+
+Commands& Game::get_commands() noexcept { return *this->commands; }
+
+Events& Game::get_events() noexcept { return this->events; }
+
+const Hierarchy& Game::get_hierarchy() {
+    // rebuilt outside of init/update only, so systems can share it
+    if (!this->locked && this->hierarchy_version != this->structure_version) {
+        this->hierarchy.rebuild(this->entities);
+        this->hierarchy_version = this->structure_version;
+    }
+    return this->hierarchy;
+}
+
+size_t Game::get_structure_version() noexcept {
+    return this->structure_version;
+}
+
+bool Game::has_child(size_t parent_id, size_t child_id) noexcept {
+    EntityRecord* child = this->entities.find(child_id);
+    return child && child->has_parent && child->parent == parent_id;
+}
+
+bool Game::has_parent(size_t entity_id) noexcept {
+    EntityRecord* record = this->entities.find(entity_id);
+    return record && record->has_parent;
+}
+
+size_t Game::get_parent(size_t entity_id) {
+    EntityRecord& record = this->get_record(entity_id);
+    if (!record.has_parent)
+        throw std::runtime_error(
+            "Tried to get parent of entity, but entity has no parent!");
+    return record.parent;
+}
+
+void Game::add_system(std::unique_ptr<System> system) {
+    this->check_unlocked("add a system");
+    this->systems.push_back(std::move(system));
+}
+
+void Game::set_update_policy(size_t type_key, double rate, size_t interval,
+                             UpdatePriority priority) {
+    this->check_unlocked("change an update rate");
+    if (rate < 0 || interval == 0)
+        throw std::runtime_error(
+            "Tried to set an update rate, but it isn't positive!");
+    UpdatePolicy& policy = this->update_policies[type_key];
+    policy = UpdatePolicy{rate, interval, priority, policy.cursor, 0};
+    auto it = std::find(this->scheduled_types.begin(),
+                        this->scheduled_types.end(), type_key);
+    bool scheduled = rate > 0 || interval > 1 || priority != HIGH_PRIORITY;
+    if (scheduled && it == this->scheduled_types.end()) {
+        this->scheduled_types.push_back(type_key);
+    } else if (!scheduled && it != this->scheduled_types.end()) {
+        this->scheduled_types.erase(it);
+    }
+    this->scheduled_mask.set(type_key, scheduled);
+}
+
+void Game::set_parallel_init(size_t type_key, size_t chunk_size) {
+    this->check_unlocked("change how a component type is initialized");
+    if (chunk_size == 0)
+        throw std::runtime_error(
+            "Tried to set an init chunk size, but it isn't positive!");
+    this->init_policies[type_key].parallel = true;
+    this->init_policies[type_key].chunk_size = chunk_size;
+    this->init_policies_used = true;
+}
+
+void Game::add_init_dependency(size_t type_key, size_t dependency_key) {
+    this->check_unlocked("change how a component type is initialized");
+    if (type_key == dependency_key)
+        throw std::runtime_error(
+            "Tried to make a component type's init depend on itself!");
+    std::vector<size_t>& dependencies =
+        this->init_policies[type_key].dependencies;
+    if (std::find(dependencies.begin(), dependencies.end(), dependency_key) ==
+        dependencies.end()) {
+        dependencies.push_back(dependency_key);
+    }
+    this->init_policies_used = true;
+}
+
+void Game::init_components(Interface& interface) {
+    // one task per component type, in the order the types first appear
+    // but with every type after the types it depends on
+    std::vector<size_t> order;
+    std::vector<char> state(MAX_COMPONENT_TYPES, 0);
+    ComponentMask present;
+    for (auto& archetype : this->archetypes) {
+        for (Column& column : archetype->get_columns()) {
+            present.set(column.get_type().type_key);
+        }
+    }
+    std::function<void(size_t)> visit = [&](size_t type_key) {
+        if (state[type_key] == 2) {
+            return;
+        }
+        if (state[type_key] == 1)
+            throw std::runtime_error(
+                "Tried to initialize the components, but their init "
+                "dependencies form a cycle!");
+        state[type_key] = 1;
+        for (size_t dependency : this->init_policies[type_key].dependencies) {
+            if (present.test(dependency)) {
+                visit(dependency);
+            }
+        }
+        state[type_key] = 2;
+        order.push_back(type_key);
+    };
+    for (auto& archetype : this->archetypes) {
+        for (Column& column : archetype->get_columns()) {
+            visit(column.get_type().type_key);
+        }
+    }
+    // a parallel type only conflicts with the types it depends on, all
+    // other types may touch anything and are exclusive
+    std::vector<Access> accesses;
+    for (size_t type_key : order) {
+        const InitPolicy& policy = this->init_policies[type_key];
+        Access access;
+        if (policy.parallel) {
+            access.write(type_key);
+            for (size_t dependency : policy.dependencies) {
+                access.read(dependency);
+            }
+        }
+        accesses.push_back(access);
+    }
+    threading::ThreadPool& pool = this->scheduler.get_thread_pool();
+    this->scheduler.run(accesses, [&](size_t task) {
+        size_t type_key = order[task];
+        const InitPolicy& policy = this->init_policies[type_key];
+        for (auto& archetype : this->archetypes) {
+            if (!archetype->has_column(type_key)) {
+                continue;
+            }
+            Column& column = archetype->get_column(type_key);
+            if (!policy.parallel) {
+                column.init_all(interface);
+                continue;
+            }
+            pool.parallel_for(column.size(), policy.chunk_size,
+                              [&](size_t begin, size_t end) {
+                                  column.init_range(begin, end - begin,
+                                                    interface);
+                              });
+        }
+    });
+}
+
+void Game::update_slice(size_t type_key, Interface& interface) {
+    UpdatePolicy& policy = this->update_policies[type_key];
+    size_t interval = policy.interval;
+    if (policy.rate > 0) {
+        if (interface.get_tick_length() <= 0)
+            throw std::runtime_error(
+                "Tried to update components at a fixed rate, but there is "
+                "no tick length to convert the rate with!");
+        // rates are turned into intervals of the running loop's ticks
+        double ticks = 1.0 / (policy.rate * interface.get_tick_length());
+        interval = std::max<size_t>((size_t)(ticks + 0.5), 1);
+    }
+    // disabled entities are left out of the sequence of rows
+    size_t disabled_key = component_key<Disabled>();
+    auto participates = [&](Archetype& archetype) {
+        return archetype.has_column(type_key) &&
+               !archetype.get_mask().test(disabled_key);
+    };
+    size_t total = 0;
+    for (auto& archetype : this->archetypes) {
+        if (participates(*archetype)) {
+            total += archetype->size();
+        }
+    }
+    if (total == 0) {
+        return;
+    }
+    size_t begin = policy.cursor % total;
+    size_t remaining = (total + interval - 1) / interval;
+    policy.cursor = (begin + remaining) % total;
+    // walk the archetypes as one sequence of rows, wrapping at the end
+    while (remaining > 0) {
+        size_t offset = 0;
+        for (auto& archetype : this->archetypes) {
+            if (remaining == 0) {
+                break;
+            }
+            if (!participates(*archetype)) {
+                continue;
+            }
+            size_t size = archetype->size();
+            if (begin < offset + size) {
+                size_t row = begin - offset;
+                size_t count = std::min(size - row, remaining);
+                Column& column = archetype->get_column(type_key);
+                ProfileScope scope(this->profiler, column.get_type(), count);
+                column.update_range(row, count, interface);
+                remaining -= count;
+                begin += count;
+            }
+            offset += size;
+        }
+        begin = 0;
+    }
+}
+
+void Game::set_frame_budget(double seconds) noexcept {
+    this->frame_budget = seconds;
+}
+
+double Game::get_frame_budget() noexcept { return this->frame_budget; }
+
+double Game::get_last_update_time() noexcept {
+    return this->last_update_time;
+}
+
+size_t Game::get_deferred_updates() noexcept {
+    return this->deferred_updates;
+}
+
+Profiler& Game::get_profiler() noexcept { return this->profiler; }
+
+threading::ThreadPool& Game::get_thread_pool() noexcept {
+    return this->scheduler.get_thread_pool();
+}
+
+size_t Game::get_entity_count() noexcept { return this->entities.size(); }
+
+size_t Game::get_archetype_count() noexcept {
+    return this->archetypes.size();
 }
 
 void Game::init(Interface& interface) {
-    for (auto& child : this->entities) {
-        child.second.init(interface);
+    this->get_hierarchy();
+    {
+        LockGuard guard(this->locked);
+        if (this->init_policies_used) {
+            this->init_components(interface);
+        } else {
+            for (auto& archetype : this->archetypes) {
+                archetype->init(interface);
+            }
+        }
+        for (auto& system : this->systems) {
+            system->init(*this, interface);
+        }
+    }
+    this->commands->apply(*this);
+}
+
+size_t Game::get_tick() noexcept { return this->tick; }
+
+size_t Game::get_last_update_tick() noexcept {
+    return this->last_update_tick;
+}
+
+size_t Game::get_change_tick() noexcept {
+    if (running_system.game == this) {
+        return running_system.tick;
+    }
+    return this->tick;
+}
+
+size_t Game::get_change_threshold() noexcept {
+    if (running_system.game == this) {
+        return running_system.since;
     }
+    return this->last_update_tick;
 }
 
 void Game::update(Interface& interface) {
-    for (auto& child : this->entities) {
-        child.second.update(interface);
+    // every update and render starts a new tick. changes are stamped with
+    // the current tick, so filtering from the start of the previous update
+    // on can't miss one, but may see it twice. systems get a tick each on
+    // top, so they can filter from right after their own last run instead.
+    this->tick++;
+    this->last_update_tick = this->update_tick;
+    this->update_tick = this->tick;
+    this->events.swap();
+    this->get_hierarchy();
+    this->profiler.begin_frame(this->systems.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        LockGuard guard(this->locked);
+        size_t disabled_key = component_key<Disabled>();
+        for (auto& archetype : this->archetypes) {
+            if (archetype->get_mask().test(disabled_key)) {
+                continue;
+            }
+            archetype->update(interface, this->scheduled_mask,
+                              this->profiler);
+        }
+        for (size_t type_key : this->scheduled_types) {
+            if (this->update_policies[type_key].priority == HIGH_PRIORITY) {
+                this->update_slice(type_key, interface);
+            }
+        }
+        for (size_t type_key : this->scheduled_types) {
+            if (this->update_policies[type_key].priority != LOW_PRIORITY) {
+                continue;
+            }
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            UpdatePolicy& policy = this->update_policies[type_key];
+            if (this->frame_budget > 0 &&
+                elapsed.count() >= this->frame_budget &&
+                policy.deferrals < MAX_DEFERRALS) {
+                // the slice stays where it is and runs next update
+                policy.deferrals++;
+                this->deferred_updates++;
+                continue;
+            }
+            policy.deferrals = 0;
+            this->update_slice(type_key, interface);
+        }
+        // everything stamped while or after the systems run, including
+        // from their worker threads, is newer than every system's tick
+        size_t first_system_tick = this->tick + 1;
+        this->tick += this->systems.size() + 1;
+        this->scheduler.run(this->systems, *this, interface,
+                            first_system_tick);
+    }
+    this->last_update_time = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    this->profiler.end_frame(
+        this->last_update_time,
+        interface.has_logger() ? &interface.get_logger() : nullptr);
+    this->commands->apply(*this);
+}
+
+void Game::render(Interface& interface) {
+    this->tick++;
+    {
+        LockGuard guard(this->locked);
+        size_t disabled_key = component_key<Disabled>();
+        for (auto& archetype : this->archetypes) {
+            if (archetype->get_mask().test(disabled_key)) {
+                continue;
+            }
+            archetype->render(interface);
+        }
+        for (auto& system : this->systems) {
+            system->render(*this, interface);
+        }
     }
+    this->commands->apply(*this);
 }
 
-Game::~Game() {}
\ No newline at end of file
+Game::~Game() {}
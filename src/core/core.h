@@ -2,26 +2,48 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "archetype.h"
+#include "events.h"
+#include "hierarchy.h"
+#include "profiler.h"
+#include "registry.h"
+#include "scheduler.h"
 #include "../render/render.h"
 #include "../util/timer.h"
 
 namespace core {
     class Game;
+    class Commands;
+    class Prefab;
+
+    // tags are empty types that are stored only as a bit in the entity's
+    // component mask, without any per-entity data. disabled entities carry
+    // this tag, so updates and views skip them a whole archetype at a time.
+    struct Disabled {};
 
     class Interface {
         logging::Logger* logger;
         render::Renderer* renderer;
         timer::Time* time;
         Game* game;
+        double tick_length;
+        float alpha;
 
        public:
         Interface();
         Interface(logging::Logger& logger, render::Renderer& renderer,
                   timer::Time& time, Game& game);
+        Interface(logging::Logger& logger, timer::Time& time, Game& game);
         render::Renderer& get_renderer();
         bool has_renderer();
         logging::Logger& get_logger();
@@ -30,117 +52,834 @@ namespace core {
         bool has_time();
         Game& get_game();
         bool has_game();
+        // fixed step of the running Loop and how far rendering is between
+        // its last two ticks
+        double get_tick_length();
+        float get_alpha();
+        void _set_tick(double tick_length, float alpha);
     };
 
-    class Entity;
+    // lightweight handle to an entity owned by a Game. the components
+    // themselves live in the game's archetype storage, so handles can be
+    // copied freely. once the entity is destroyed the handle is stale and
+    // every access through it throws.
+    class Entity {
+       private:
+        Game* game;
+        size_t id;
+
+       public:
+        Entity();
+        Entity(Game& game, size_t id);
+        bool is_enabled();
+        void set_active(bool state);
+        template <class T>
+        inline void add_tag();
+        template <class T>
+        inline void remove_tag();
+        template <class T>
+        inline bool has_tag() noexcept;
+        template <class T>
+        inline void add_component(std::unique_ptr<T> component);
+        template <class T, class... Args>
+        inline T& add_component(Args&&... args);
+        void add_child(Entity entity);
+        Entity get_child(size_t entity_id);
+        void destroy_child(size_t entity_id);
+        bool has_child(size_t entity_id) noexcept;
+        size_t get_id() noexcept;
+        bool has_parent() noexcept;
+        template <class t>
+        inline void remove_component();
+        template <class t>
+        inline bool has_component() noexcept;
+        template <class T>
+        inline std::vector<T*> get_component();
+        // see Game::get_single_component for how long the reference lives
+        template <class T>
+        inline T& get_single_component();
+        template <class T>
+        inline void mark_changed();
+        template <class T>
+        inline size_t get_added_tick();
+        template <class T>
+        inline size_t get_changed_tick();
+        Entity get_parent();
+    };
 
     class Component {
        private:
         bool enabled;
 
        protected:
-        Entity* entity;
+        Entity entity;
 
        public:
         Component();
         virtual void update(Interface& interface) = 0;
         virtual void init(Interface& interface) = 0;
+        // called once per displayed frame, between fixed updates
+        virtual void render(Interface& interface) { (void)(interface); }
         bool is_enabled();
         void set_active(bool state);
-        void set_entity(Entity& entity);
+        void set_entity(Entity entity);
         virtual bool is_unique() = 0;
         virtual ~Component();
     };
 
-    class Entity {
-       private:
-        size_t id;
+    // components of a type with low priority are the first to be deferred
+    // to the next update once the frame budget is used up, but at most
+    // Game::MAX_DEFERRALS updates in a row
+    enum UpdatePriority { HIGH_PRIORITY, LOW_PRIORITY };
 
-        bool enabled;
-        std::map<size_t, std::vector<std::unique_ptr<Component>>> components;
+    // behaviour that runs once per frame over many entities at a time,
+    // usually by iterating a Game::view. systems run after all components
+    // were updated. systems that declare their access through get_access
+    // may run concurrently with each other, otherwise they run in the order
+    // they were added. render always runs on the main thread.
+    class System {
+        size_t last_run_tick;
+
+       public:
+        System();
+        virtual void init(Game& game, Interface& interface) = 0;
+        virtual void update(Game& game, Interface& interface) = 0;
+        virtual void render(Game& game, Interface& interface);
+        virtual Access get_access();
+        // the tick the last update ran at, 0 before the first one
+        size_t get_last_run_tick() const noexcept;
+        void _set_last_run_tick(size_t tick) noexcept;
+        virtual ~System();
+    };
 
-        std::map<size_t, Entity> children;
-        Entity* parent;
+    // marks the calling thread as running a system's update at its own
+    // tick: changes marked on the thread are stamped with that tick, and
+    // the default change filters start right after the system's last run,
+    // so the system sees every change exactly once. the tick becomes the
+    // last run tick when the scope ends.
+    class SystemScope {
+        Game& game;
+        System& system;
+        size_t tick;
 
        public:
-        explicit Entity(size_t id);
-        Entity(Entity&& other);
-        Entity(const Entity& other) = delete;
-        bool is_enabled();
-        void set_active(bool state);
-        void add_component(std::unique_ptr<Component> component);
-        void add_child(Entity entity);
-        Entity& get_child(size_t entity_id);
-        void destroy_child(size_t entity_id);
-        bool has_child(size_t entity_id) noexcept;
-        size_t get_id() noexcept;
-        bool has_parent() noexcept;
-        template <class t>
-        inline void remove_component();
-        template <class t>
-        inline bool has_component() noexcept;
+        SystemScope(Game& game, System& system, size_t tick);
+        SystemScope(const SystemScope&) = delete;
+        SystemScope& operator=(const SystemScope&) = delete;
+        ~SystemScope();
+    };
+
+    struct TickFilter {
+        size_t type_key;
+        bool added;
+        size_t since;
+    };
+
+    // all entities that have every component in Ts. components are handed
+    // out per archetype as contiguous arrays; a const component type only
+    // grants read access. the changed/added filters skip rows whose
+    // component wasn't touched at or after the given game tick: by default
+    // after the last run inside a system, since the start of the previous
+    // update anywhere else. writing through a view doesn't count as a
+    // change, only Game::mark_changed does. with/without narrow the view
+    // down by components or tags the entities must or mustn't have.
+    template <class... Ts>
+    class View {
+        Game* game;
+        std::vector<Archetype*> archetypes;
+        std::vector<TickFilter> filters;
         template <class T>
-        inline std::vector<std::unique_ptr<core::Component>>& get_component();
+        View& filter(bool added, size_t since);
+        template <class F>
+        void each_run(Archetype& archetype, size_t begin, size_t end,
+                      F function) const;
+        template <class F>
+        static void each_row(Game& game, Archetype& archetype, F& function,
+                             size_t begin, size_t end, Ts*... columns);
+
+       public:
+        View(Game& game, std::vector<Archetype*> archetypes);
         template <class T>
-        inline T& get_single_component();
-        Entity& get_parent();
-        void init(Interface& interface);
-        void update(Interface& interface);
-        ~Entity();
+        View& changed();
+        template <class T>
+        View& changed(size_t since);
+        template <class T>
+        View& added();
+        template <class T>
+        View& added(size_t since);
+        template <class T>
+        View& with();
+        template <class T>
+        View& without();
+        size_t size() const;
+        template <class F>
+        void each(F function);
+        template <class F>
+        void each_chunk(F function);
+        template <class F>
+        void each_parallel(F function, size_t chunk_size = 1024);
     };
 
     class Game {
        private:
-        size_t entity_id;
+        // how often the components of a type are updated. a type updated
+        // every n updates is time-sliced: each update handles the next
+        // 1/n of its components, so the cost stays flat across frames.
+        struct UpdatePolicy {
+            double rate;
+            size_t interval;
+            UpdatePriority priority;
+            size_t cursor;
+            size_t deferrals;
+        };
+
+        // how the components of a type may be initialized. types that
+        // aren't parallel are initialized alone on the calling thread.
+        struct InitPolicy {
+            bool parallel;
+            size_t chunk_size;
+            std::vector<size_t> dependencies;
+        };
 
-        std::map<size_t, Entity> entities;
+        bool locked;
+        size_t tick;
+        size_t update_tick;
+        size_t last_update_tick;
+        size_t structure_version;
+        size_t hierarchy_version;
 
-        size_t next_id();
+        Registry entities;
+        Hierarchy hierarchy;
+        Events events;
+        std::vector<std::unique_ptr<Archetype>> archetypes;
+        std::unordered_map<ComponentMask, size_t> archetype_ids;
+        std::vector<std::unique_ptr<System>> systems;
+        std::vector<UpdatePolicy> update_policies;
+        std::vector<InitPolicy> init_policies;
+        bool init_policies_used;
+        std::vector<size_t> scheduled_types;
+        ComponentMask scheduled_mask;
+        double frame_budget;
+        double last_update_time;
+        size_t deferred_updates;
+        Scheduler scheduler;
+        Profiler profiler;
+        std::unique_ptr<Commands> commands;
+
+        EntityRecord& get_record(size_t entity_id);
+        void check_unlocked(const char* action);
+        size_t find_archetype(size_t source, size_t type_key,
+                              const ColumnType* type, bool add);
+        size_t find_archetype(std::vector<const ColumnType*> types,
+                              const ComponentMask& tags = ComponentMask());
+        void move_entity(EntityRecord& record, size_t archetype);
+        void remove_entity(size_t entity_id);
+        template <class T>
+        inline T& insert_component(size_t entity_id, T&& component);
+        void set_update_policy(size_t type_key, double rate, size_t interval,
+                               UpdatePriority priority);
+        void update_slice(size_t type_key, Interface& interface);
+        void set_parallel_init(size_t type_key, size_t chunk_size);
+        void add_init_dependency(size_t type_key, size_t dependency_key);
+        void init_components(Interface& interface);
+        void set_tag(size_t entity_id, size_t tag_key, bool state);
+        template <class... Ts>
+        inline View<Ts...> match(bool include_disabled);
+        friend class Snapshots;
+        friend class Profiler;
 
        public:
+        // a low priority slice deferred this many updates in a row runs
+        // regardless of the budget, so it can't starve
+        static constexpr size_t MAX_DEFERRALS = 4;
+
         Game();
+        explicit Game(size_t worker_count);
+        Game(const Game& other) = delete;
         Entity create_entity();
+        std::vector<Entity> instantiate(const Prefab& prefab, size_t count);
         void add_entity(Entity entity);
-        Entity& get_entity(size_t entity_id);
+        Entity get_entity(size_t entity_id);
         void destroy_entity(size_t entity_id);
         bool has_entity(size_t entity_id) noexcept;
+        bool is_enabled(size_t entity_id);
+        // adds or removes the Disabled tag, which is a structural change
+        void set_active(size_t entity_id, bool state);
+        void add_child(size_t parent_id, size_t child_id);
+        bool has_child(size_t parent_id, size_t child_id) noexcept;
+        bool has_parent(size_t entity_id) noexcept;
+        size_t get_parent(size_t entity_id);
+        void set_parent(size_t entity_id, size_t parent_id);
+        void reserve_entities(size_t count);
+        Commands& get_commands() noexcept;
+        Events& get_events() noexcept;
+        template <class T>
+        inline EventQueue<T>& add_events();
+        const Hierarchy& get_hierarchy();
+        size_t get_structure_version() noexcept;
+        template <class T>
+        inline void add_tag(size_t entity_id);
+        template <class T>
+        inline void remove_tag(size_t entity_id);
+        template <class T>
+        inline bool has_tag(size_t entity_id) noexcept;
+        template <class T>
+        inline void add_component(size_t entity_id,
+                                  std::unique_ptr<T> component);
+        template <class T, class... Args>
+        inline T& emplace_component(size_t entity_id, Args&&... args);
+        template <class T>
+        inline void remove_component(size_t entity_id);
+        template <class T>
+        inline bool has_component(size_t entity_id) noexcept;
+        template <class T>
+        inline std::vector<T*> get_component(size_t entity_id);
+        // the returned reference points into the column of the entity's
+        // archetype. columns move their rows when they grow, when any entity
+        // leaves the archetype and when this entity changes archetype, so
+        // the reference is only valid until the next structural change of
+        // the game (creating or destroying entities, adding or removing
+        // components or tags). keep the entity id and look it up again.
+        template <class T>
+        inline T& get_single_component(size_t entity_id);
+        // stamps the component with the change tick. nothing else does:
+        // writes through views or references stay invisible to changed<T>()
+        // until the component is marked
+        template <class T>
+        inline void mark_changed(size_t entity_id);
+        template <class T>
+        inline size_t get_added_tick(size_t entity_id);
+        template <class T>
+        inline size_t get_changed_tick(size_t entity_id);
+        size_t get_tick() noexcept;
+        size_t get_last_update_tick() noexcept;
+        // the running system's tick on its thread, the game's tick elsewhere
+        size_t get_change_tick() noexcept;
+        // where changed/added filters start by default, see View
+        size_t get_change_threshold() noexcept;
+        // views skip disabled entities, view_all includes them
+        template <class... Ts>
+        inline View<Ts...> view();
+        template <class... Ts>
+        inline View<Ts...> view_all();
+        void add_system(std::unique_ptr<System> system);
+        // rates are converted to intervals of the running loop's ticks,
+        // updating without a loop tick length throws
+        template <class T>
+        inline void set_update_rate(double rate,
+                                    UpdatePriority priority = HIGH_PRIORITY);
+        template <class T>
+        inline void set_update_interval(
+            size_t interval, UpdatePriority priority = HIGH_PRIORITY);
+        // declares that the init of T is thread-safe: its components are
+        // initialized in chunks on the thread pool, concurrently with
+        // other parallel types
+        template <class T>
+        inline void set_parallel_init(size_t chunk_size = 64);
+        // every component of U is initialized before any component of T
+        template <class T, class U>
+        inline void add_init_dependency();
+        void set_frame_budget(double seconds) noexcept;
+        double get_frame_budget() noexcept;
+        double get_last_update_time() noexcept;
+        size_t get_deferred_updates() noexcept;
+        Profiler& get_profiler() noexcept;
+        threading::ThreadPool& get_thread_pool() noexcept;
+        size_t get_entity_count() noexcept;
+        size_t get_archetype_count() noexcept;
         void init(Interface& interface);
         void update(Interface& interface);
+        void render(Interface& interface);
         ~Game();
     };
 }
 
+template <class T>
+void core::Entity::add_component(std::unique_ptr<T> component) {
+    this->game->add_component<T>(this->id, std::move(component));
+}
+
+template <class T, class... Args>
+T& core::Entity::add_component(Args&&... args) {
+    return this->game->emplace_component<T>(this->id,
+                                            std::forward<Args>(args)...);
+}
+
 template <class t>
 bool core::Entity::has_component() noexcept {
-    return this->components.find(typeid(t).hash_code()) !=
-           this->components.end();
+    return this->game->has_component<t>(this->id);
+}
+
+template <class T>
+void core::Entity::add_tag() {
+    this->game->add_tag<T>(this->id);
+}
+
+template <class T>
+void core::Entity::remove_tag() {
+    this->game->remove_tag<T>(this->id);
+}
+
+template <class T>
+bool core::Entity::has_tag() noexcept {
+    return this->game->has_tag<T>(this->id);
 }
 
 template <class t>
 void core::Entity::remove_component() {
-    if (this->has_component<t>()) {
-        this->components.erase(typeid(t).hash_code());
+    this->game->remove_component<t>(this->id);
+}
+
+template <class T>
+std::vector<T*> core::Entity::get_component() {
+    return this->game->get_component<T>(this->id);
+}
+
+template <class T>
+inline T& core::Entity::get_single_component() {
+    return this->game->get_single_component<T>(this->id);
+}
+
+template <class T>
+void core::Entity::mark_changed() {
+    this->game->mark_changed<T>(this->id);
+}
+
+template <class T>
+size_t core::Entity::get_added_tick() {
+    return this->game->get_added_tick<T>(this->id);
+}
+
+template <class T>
+size_t core::Entity::get_changed_tick() {
+    return this->game->get_changed_tick<T>(this->id);
+}
+
+template <class... Ts>
+core::View<Ts...>::View(Game& game, std::vector<Archetype*> archetypes)
+    : game(&game), archetypes(std::move(archetypes)) {
+    for (Archetype* archetype : this->archetypes) {
+        for (const ColumnType* type :
+             {&archetype->get_column(component_key<Ts>()).get_type()...}) {
+            if (!type->unique)
+                throw std::runtime_error(
+                    "Tried to view non-unique Component " +
+                    std::string(type->name) + "!");
+        }
+    }
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::filter(bool added, size_t since) {
+    size_t type_key = component_key<T>();
+    this->archetypes.erase(
+        std::remove_if(this->archetypes.begin(), this->archetypes.end(),
+                       [type_key](Archetype* archetype) {
+                           return !archetype->has_column(type_key);
+                       }),
+        this->archetypes.end());
+    this->filters.push_back(TickFilter{type_key, added, since});
+    return *this;
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::with() {
+    size_t type_key = component_key<T>();
+    this->archetypes.erase(
+        std::remove_if(this->archetypes.begin(), this->archetypes.end(),
+                       [type_key](Archetype* archetype) {
+                           return !archetype->get_mask().test(type_key);
+                       }),
+        this->archetypes.end());
+    return *this;
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::without() {
+    size_t type_key = component_key<T>();
+    this->archetypes.erase(
+        std::remove_if(this->archetypes.begin(), this->archetypes.end(),
+                       [type_key](Archetype* archetype) {
+                           return archetype->get_mask().test(type_key);
+                       }),
+        this->archetypes.end());
+    return *this;
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::changed() {
+    return this->filter<T>(false, this->game->get_change_threshold());
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::changed(size_t since) {
+    return this->filter<T>(false, since);
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::added() {
+    return this->filter<T>(true, this->game->get_change_threshold());
+}
+
+template <class... Ts>
+template <class T>
+core::View<Ts...>& core::View<Ts...>::added(size_t since) {
+    return this->filter<T>(true, since);
+}
+
+template <class... Ts>
+template <class F>
+void core::View<Ts...>::each_run(Archetype& archetype, size_t begin,
+                                 size_t end, F function) const {
+    if (this->filters.empty()) {
+        if (begin < end) {
+            function(begin, end);
+        }
+        return;
+    }
+    std::vector<std::pair<const size_t*, size_t>> ticks;
+    for (const TickFilter& filter : this->filters) {
+        Column& column = archetype.get_column(filter.type_key);
+        ticks.push_back({filter.added ? column.get_added_ticks()
+                                      : column.get_changed_ticks(),
+                         filter.since});
+    }
+    auto matches = [&ticks](size_t row) {
+        for (auto& tick : ticks) {
+            if (tick.first[row] < tick.second) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // hand out runs of consecutive matching rows
+    size_t row = begin;
+    while (row < end) {
+        while (row < end && !matches(row)) {
+            row++;
+        }
+        size_t run = row;
+        while (row < end && matches(row)) {
+            row++;
+        }
+        if (run < row) {
+            function(run, row);
+        }
+    }
+}
+
+template <class... Ts>
+size_t core::View<Ts...>::size() const {
+    size_t count = 0;
+    for (Archetype* archetype : this->archetypes) {
+        this->each_run(*archetype, 0, archetype->size(),
+                       [&count](size_t begin, size_t end) {
+                           count += end - begin;
+                       });
+    }
+    return count;
+}
+
+template <class... Ts>
+template <class F>
+void core::View<Ts...>::each_row(Game& game, Archetype& archetype,
+                                 F& function, size_t begin, size_t end,
+                                 Ts*... columns) {
+    for (size_t row = begin; row < end; row++) {
+        if constexpr (std::is_invocable<F&, Entity, Ts&...>::value) {
+            function(Entity(game, archetype.get_entity(row)), columns[row]...);
+        } else {
+            function(columns[row]...);
+        }
+    }
+}
+
+template <class... Ts>
+template <class F>
+void core::View<Ts...>::each(F function) {
+    for (Archetype* archetype : this->archetypes) {
+        std::tuple<Ts*...> columns(
+            (Ts*)archetype->get_column(component_key<Ts>()).data()...);
+        this->each_run(
+            *archetype, 0, archetype->size(), [&](size_t begin, size_t end) {
+                std::apply(
+                    [&](Ts*... column) {
+                        each_row(*this->game, *archetype, function, begin,
+                                 end, column...);
+                    },
+                    columns);
+            });
+    }
+}
+
+template <class... Ts>
+template <class F>
+void core::View<Ts...>::each_parallel(F function, size_t chunk_size) {
+    threading::ThreadPool& pool = this->game->get_thread_pool();
+    for (Archetype* archetype : this->archetypes) {
+        Game& game = *this->game;
+        Archetype& rows = *archetype;
+        std::tuple<Ts*...> columns(
+            (Ts*)archetype->get_column(component_key<Ts>()).data()...);
+        pool.parallel_for(
+            archetype->size(), chunk_size, [&](size_t begin, size_t end) {
+                this->each_run(rows, begin, end, [&](size_t from, size_t to) {
+                    std::apply(
+                        [&](Ts*... column) {
+                            each_row(game, rows, function, from, to,
+                                     column...);
+                        },
+                        columns);
+                });
+            });
+    }
+}
+
+template <class... Ts>
+template <class F>
+void core::View<Ts...>::each_chunk(F function) {
+    for (Archetype* archetype : this->archetypes) {
+        std::tuple<Ts*...> columns(
+            (Ts*)archetype->get_column(component_key<Ts>()).data()...);
+        this->each_run(
+            *archetype, 0, archetype->size(), [&](size_t begin, size_t end) {
+                std::apply(
+                    [&](Ts*... column) {
+                        function(end - begin, (column + begin)...);
+                    },
+                    columns);
+            });
+    }
+}
+
+template <class... Ts>
+core::View<Ts...> core::Game::match(bool include_disabled) {
+    ComponentMask query;
+    (query.set(component_key<Ts>()), ...);
+    size_t disabled_key = component_key<Disabled>();
+    std::vector<Archetype*> matches;
+    for (auto& archetype : this->archetypes) {
+        if ((archetype->get_mask() & query) == query &&
+            (include_disabled || !archetype->get_mask().test(disabled_key))) {
+            matches.push_back(archetype.get());
+        }
+    }
+    return View<Ts...>(*this, std::move(matches));
+}
+
+template <class... Ts>
+core::View<Ts...> core::Game::view() {
+    return this->match<Ts...>(false);
+}
+
+template <class... Ts>
+core::View<Ts...> core::Game::view_all() {
+    return this->match<Ts...>(true);
+}
+
+template <class T>
+void core::Game::add_component(size_t entity_id,
+                               std::unique_ptr<T> component) {
+    if (typeid(*component) != typeid(T))
+        throw std::runtime_error("Tried to add Component " +
+                                 std::string(typeid(*component).name()) +
+                                 " through a pointer to " +
+                                 std::string(typeid(T).name()) + "!");
+    this->insert_component<T>(entity_id, std::move(*component));
+}
+
+template <class T, class... Args>
+T& core::Game::emplace_component(size_t entity_id, Args&&... args) {
+    // the component has to exist before is_unique can be asked, so it is
+    // built on the stack and moved into its column without a heap copy
+    T component(std::forward<Args>(args)...);
+    return this->insert_component<T>(entity_id, std::move(component));
+}
+
+template <class T>
+T& core::Game::insert_component(size_t entity_id, T&& component) {
+    static_assert(std::is_base_of<Component, T>::value,
+                  "components must derive from core::Component");
+    this->check_unlocked("add a component");
+    EntityRecord& record = this->get_record(entity_id);
+    component.set_entity(Entity(*this, entity_id));
+    size_t type_key = component_key<T>();
+    Archetype& source = *this->archetypes[record.archetype];
+    if (source.has_column(type_key)) {
+        Column& column = source.get_column(type_key);
+        if (column.get_type().unique)
+            throw std::runtime_error("Tried to add unique Component " +
+                                     std::string(typeid(T).name()) +
+                                     " twice!");
+        std::vector<T>& components = *(std::vector<T>*)column.get(record.row);
+        components.push_back(std::move(component));
+        column.set_changed(record.row, this->tick);
+        return components.back();
+    }
+    const ColumnType& type = column_type<T>(component.is_unique());
+    size_t target =
+        this->find_archetype(record.archetype, type_key, &type, true);
+    Column& column = this->archetypes[target]->get_column(type_key);
+    void* slot = column.prepare_push();
+    if (type.unique) {
+        new (slot) T(std::move(component));
     } else {
+        new (slot) std::vector<T>();
+        ((std::vector<T>*)slot)->push_back(std::move(component));
+    }
+    column.commit_push(this->tick);
+    this->move_entity(record, target);
+    if (type.unique) {
+        return *(T*)column.get(record.row);
+    }
+    return ((std::vector<T>*)column.get(record.row))->back();
+}
+
+template <class T>
+bool core::Game::has_component(size_t entity_id) noexcept {
+    EntityRecord* record = this->entities.find(entity_id);
+    return record && record->mask.test(component_key<T>());
+}
+
+template <class T>
+void core::Game::remove_component(size_t entity_id) {
+    this->check_unlocked("remove a component");
+    if (!this->has_component<T>(entity_id))
         throw std::runtime_error("Tried to remove " +
-                                 std::string(typeid(t).name()) +
+                                 std::string(typeid(T).name()) +
                                  ", but it doesn't exist!");
-    }
+    EntityRecord& record = this->get_record(entity_id);
+    const ColumnType& type = this->archetypes[record.archetype]
+                                 ->get_column(component_key<T>())
+                                 .get_type();
+    size_t target = this->find_archetype(record.archetype, type.type_key,
+                                         &type, false);
+    this->move_entity(record, target);
 }
 
 template <class T>
-std::vector<std::unique_ptr<core::Component>>& core::Entity::get_component() {
-    if (this->has_component<T>()) {
-        return this->components.at(typeid(T).hash_code());
+void core::Game::add_tag(size_t entity_id) {
+    static_assert(std::is_empty<T>::value, "tags have to be empty types");
+    this->set_tag(entity_id, component_key<T>(), true);
+}
+
+template <class T>
+void core::Game::remove_tag(size_t entity_id) {
+    static_assert(std::is_empty<T>::value, "tags have to be empty types");
+    this->set_tag(entity_id, component_key<T>(), false);
+}
+
+template <class T>
+bool core::Game::has_tag(size_t entity_id) noexcept {
+    static_assert(std::is_empty<T>::value, "tags have to be empty types");
+    EntityRecord* record = this->entities.find(entity_id);
+    return record && record->mask.test(component_key<T>());
+}
+
+template <class T>
+std::vector<T*> core::Game::get_component(size_t entity_id) {
+    size_t type_key = component_key<T>();
+    EntityRecord* record = this->entities.find(entity_id);
+    if (!record || !record->mask.test(type_key))
+        throw std::runtime_error("Tried to get " +
+                                 std::string(typeid(T).name()) +
+                                 ", but it doesn't exist!");
+    Column& column = this->archetypes[record->archetype]->get_column(type_key);
+    std::vector<T*> components;
+    if (column.get_type().unique) {
+        components.push_back((T*)column.get(record->row));
     } else {
+        for (T& component : *(std::vector<T>*)column.get(record->row)) {
+            components.push_back(&component);
+        }
+    }
+    return components;
+}
+
+template <class T>
+T& core::Game::get_single_component(size_t entity_id) {
+    size_t type_key = component_key<T>();
+    EntityRecord* record = this->entities.find(entity_id);
+    if (!record || !record->mask.test(type_key))
         throw std::runtime_error("Tried to get " +
                                  std::string(typeid(T).name()) +
                                  ", but it doesn't exist!");
+    Column& column = this->archetypes[record->archetype]->get_column(type_key);
+    if (column.get_type().unique) {
+        return *(T*)column.get(record->row);
     }
+    return ((std::vector<T>*)column.get(record->row))->at(0);
 }
 
 template <class T>
-inline T& core::Entity::get_single_component() {
-    std::vector<std::unique_ptr<core::Component>>& components =
-        this->get_component<T>();
-    return (T&)*components.at(0);
-}
\ No newline at end of file
+void core::Game::set_update_rate(double rate, UpdatePriority priority) {
+    this->set_update_policy(component_key<T>(), rate, 1, priority);
+}
+
+template <class T>
+void core::Game::set_update_interval(size_t interval,
+                                     UpdatePriority priority) {
+    this->set_update_policy(component_key<T>(), 0, interval, priority);
+}
+
+template <class T>
+void core::Game::set_parallel_init(size_t chunk_size) {
+    this->set_parallel_init(component_key<T>(), chunk_size);
+}
+
+template <class T, class U>
+void core::Game::add_init_dependency() {
+    this->add_init_dependency(component_key<T>(), component_key<U>());
+}
+
+template <class T>
+core::EventQueue<T>& core::Game::add_events() {
+    this->check_unlocked("add an event type");
+    return this->events.add<T>();
+}
+
+template <class T>
+void core::Game::mark_changed(size_t entity_id) {
+    size_t type_key = component_key<T>();
+    EntityRecord* record = this->entities.find(entity_id);
+    if (!record || !record->mask.test(type_key))
+        throw std::runtime_error("Tried to mark " +
+                                 std::string(typeid(T).name()) +
+                                 " as changed, but it doesn't exist!");
+    this->archetypes[record->archetype]
+        ->get_column(type_key)
+        .set_changed(record->row, this->get_change_tick());
+}
+
+template <class T>
+size_t core::Game::get_added_tick(size_t entity_id) {
+    size_t type_key = component_key<T>();
+    EntityRecord* record = this->entities.find(entity_id);
+    if (!record || !record->mask.test(type_key))
+        throw std::runtime_error("Tried to get " +
+                                 std::string(typeid(T).name()) +
+                                 ", but it doesn't exist!");
+    Column& column = this->archetypes[record->archetype]->get_column(type_key);
+    return column.get_added_ticks()[record->row];
+}
+
+template <class T>
+size_t core::Game::get_changed_tick(size_t entity_id) {
+    size_t type_key = component_key<T>();
+    EntityRecord* record = this->entities.find(entity_id);
+    if (!record || !record->mask.test(type_key))
+        throw std::runtime_error("Tried to get " +
+                                 std::string(typeid(T).name()) +
+                                 ", but it doesn't exist!");
+    Column& column = this->archetypes[record->archetype]->get_column(type_key);
+    return column.get_changed_ticks()[record->row];
+}
+
+#include "commands.h"
+#include "prefab.h"
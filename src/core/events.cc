@@ -0,0 +1,34 @@
+#include "events.h"
+
+#include <atomic>
+
+using namespace core;
+
+size_t core::next_event_key() {
+    static std::atomic<size_t> next_key(0);
+    size_t key = next_key++;
+    if (key >= MAX_EVENT_TYPES)
+        throw std::runtime_error("reached maximum amount of event types (" +
+                                 std::to_string(MAX_EVENT_TYPES) + ")");
+    return key;
+}
+
+EventQueueBase::~EventQueueBase() {}
+
+Events::Events() : queues(MAX_EVENT_TYPES) {}
+
+void Events::swap() {
+    for (auto &queue : this->queues) {
+        if (queue) {
+            queue->swap();
+        }
+    }
+}
+
+void Events::clear() {
+    for (auto &queue : this->queues) {
+        if (queue) {
+            queue->clear();
+        }
+    }
+}
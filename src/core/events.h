@@ -0,0 +1,148 @@
+// header for typed, double-buffered event queues
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace core {
+    const size_t MAX_EVENT_TYPES = 128;
+
+    size_t next_event_key();
+
+    template <class T>
+    inline size_t event_key() {
+        static const size_t key = next_event_key();
+        return key;
+    }
+
+    class EventQueueBase {
+       public:
+        virtual void swap() = 0;
+        virtual void clear() = 0;
+        virtual ~EventQueueBase();
+    };
+
+    // events of one type, stored by value in two contiguous buffers.
+    // events sent during an update become readable in the next one and are
+    // dropped after that, so every reader sees each event exactly once if it
+    // reads once per update. sending is thread-safe, reading isn't
+    // synchronized with sending and only returns the previous update's
+    // events. both buffers keep their capacity between updates.
+    template <class T>
+    class EventQueue : public EventQueueBase {
+        std::vector<T> readable;
+        std::vector<T> pending;
+        std::mutex mutex;
+
+       public:
+        EventQueue();
+        void send(const T &event);
+        void send(T &&event);
+        template <class... Args>
+        void emplace(Args &&... args);
+        const std::vector<T> &read() const noexcept;
+        size_t size() const noexcept;
+        size_t pending_size();
+        virtual void swap();
+        virtual void clear();
+    };
+
+    // one queue per event type. types are registered up front, so looking
+    // up a queue during a parallel update doesn't need a lock.
+    class Events {
+        std::vector<std::unique_ptr<EventQueueBase>> queues;
+
+       public:
+        Events();
+        template <class T>
+        inline EventQueue<T> &add();
+        template <class T>
+        inline bool has() const noexcept;
+        template <class T>
+        inline EventQueue<T> &get();
+        void swap();
+        void clear();
+    };
+}
+
+template <class T>
+core::EventQueue<T>::EventQueue() {}
+
+template <class T>
+void core::EventQueue<T>::send(const T &event) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending.push_back(event);
+}
+
+template <class T>
+void core::EventQueue<T>::send(T &&event) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending.push_back(std::move(event));
+}
+
+template <class T>
+template <class... Args>
+void core::EventQueue<T>::emplace(Args &&... args) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending.emplace_back(std::forward<Args>(args)...);
+}
+
+template <class T>
+const std::vector<T> &core::EventQueue<T>::read() const noexcept {
+    return this->readable;
+}
+
+template <class T>
+size_t core::EventQueue<T>::size() const noexcept {
+    return this->readable.size();
+}
+
+template <class T>
+size_t core::EventQueue<T>::pending_size() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->pending.size();
+}
+
+template <class T>
+void core::EventQueue<T>::swap() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->readable.clear();
+    this->readable.swap(this->pending);
+}
+
+template <class T>
+void core::EventQueue<T>::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->readable.clear();
+    this->pending.clear();
+}
+
+template <class T>
+core::EventQueue<T> &core::Events::add() {
+    size_t key = event_key<T>();
+    if (!this->queues[key]) {
+        this->queues[key] = std::make_unique<EventQueue<T>>();
+    }
+    return *(EventQueue<T> *)this->queues[key].get();
+}
+
+template <class T>
+bool core::Events::has() const noexcept {
+    return (bool)this->queues[event_key<T>()];
+}
+
+template <class T>
+core::EventQueue<T> &core::Events::get() {
+    if (!this->has<T>())
+        throw std::runtime_error("Tried to get events of type " +
+                                 std::string(typeid(T).name()) +
+                                 ", but they weren't added!");
+    return *(EventQueue<T> *)this->queues[event_key<T>()].get();
+}
@@ -0,0 +1,54 @@
+#include "headless.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace core;
+
+Headless::Headless(Game &game, logging::Logger &logger, double tick_rate,
+                   bool paced)
+    : game(game),
+      interface(logger, this->time, game),
+      loop(game, this->interface, tick_rate),
+      paced(paced),
+      running(true) {}
+
+Interface &Headless::get_interface() noexcept { return this->interface; }
+
+Loop &Headless::get_loop() noexcept { return this->loop; }
+
+timer::Time &Headless::get_time() noexcept { return this->time; }
+
+void Headless::set_paced(bool paced) noexcept { this->paced = paced; }
+
+bool Headless::is_paced() const noexcept { return this->paced; }
+
+void Headless::init() { this->game.init(this->interface); }
+
+void Headless::run(size_t ticks) {
+    // ticks == 0 runs until stop() is called. paced runs that fell behind
+    // catch up, but never past the requested tick count. running is left as
+    // it is, so a stop() that came before the run isn't lost.
+    size_t end = this->loop.get_tick_count() + ticks;
+    this->time._frame_complete();
+    while (this->running && (ticks == 0 || this->loop.get_tick_count() < end)) {
+        if (!this->paced) {
+            this->loop.step();
+            continue;
+        }
+        double elapsed = this->time.delta_time();
+        this->time._frame_complete();
+        this->loop.advance(elapsed,
+                           ticks == 0 ? 0 : end - this->loop.get_tick_count());
+        // sleep until the next tick is due
+        double remaining = (1.0 - (double)this->loop.get_alpha()) *
+                           this->loop.get_tick_length();
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+    }
+}
+
+void Headless::start() noexcept { this->running = true; }
+
+void Headless::stop() noexcept { this->running = false; }
+
+bool Headless::is_running() const noexcept { return this->running; }
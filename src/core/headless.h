@@ -0,0 +1,40 @@
+// header for running a game without a window or renderer
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "loop.h"
+
+namespace core {
+    // drives a game on the steady clock without creating a window or GL
+    // context, e.g. for dedicated servers and benchmarks. the Interface it
+    // hands to components has no renderer. paced runs sleep between ticks to
+    // hold the tick rate, unpaced runs step as fast as possible. stop() may
+    // be called from any thread at any time, also before run(): runs return
+    // right away until start() arms the runtime again.
+    class Headless {
+        Game &game;
+        timer::Time time;
+        Interface interface;
+        Loop loop;
+        bool paced;
+        std::atomic<bool> running;
+
+       public:
+        Headless(Game &game, logging::Logger &logger, double tick_rate = 60.0,
+                 bool paced = true);
+        Headless(const Headless &other) = delete;
+        Interface &get_interface() noexcept;
+        Loop &get_loop() noexcept;
+        timer::Time &get_time() noexcept;
+        void set_paced(bool paced) noexcept;
+        bool is_paced() const noexcept;
+        void init();
+        void run(size_t ticks = 0);
+        void start() noexcept;
+        void stop() noexcept;
+        bool is_running() const noexcept;
+    };
+}
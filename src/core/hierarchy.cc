@@ -0,0 +1,40 @@
+#include "hierarchy.h"
+
+using namespace core;
+
+Hierarchy::Hierarchy() {}
+
+void Hierarchy::rebuild(Registry &registry) {
+    this->entities.clear();
+    this->parents.clear();
+    this->depths.clear();
+    for (size_t entity_id : registry.alive()) {
+        if (!registry.get(entity_id).has_parent) {
+            this->entities.push_back(entity_id);
+            this->parents.push_back(NONE);
+            this->depths.push_back(0);
+        }
+    }
+    for (size_t index = 0; index < this->entities.size(); index++) {
+        EntityRecord &record = registry.get(this->entities[index]);
+        for (size_t child : record.children) {
+            this->entities.push_back(child);
+            this->parents.push_back(index);
+            this->depths.push_back(this->depths[index] + 1);
+        }
+    }
+}
+
+size_t Hierarchy::size() const noexcept { return this->entities.size(); }
+
+size_t Hierarchy::get_entity(size_t index) const noexcept {
+    return this->entities[index];
+}
+
+size_t Hierarchy::get_parent(size_t index) const noexcept {
+    return this->parents[index];
+}
+
+uint32_t Hierarchy::get_depth(size_t index) const noexcept {
+    return this->depths[index];
+}
@@ -0,0 +1,29 @@
+// header for the flattened entity hierarchy
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "registry.h"
+
+namespace core {
+    // every live entity in breadth-first order, so parents always come
+    // before their children. parents are stored as indices into the same
+    // arrays, which lets hierarchical passes run front to back in one loop.
+    class Hierarchy {
+        std::vector<size_t> entities;
+        std::vector<size_t> parents;
+        std::vector<uint32_t> depths;
+
+       public:
+        static constexpr size_t NONE = (size_t)-1;
+        Hierarchy();
+        void rebuild(Registry &registry);
+        size_t size() const noexcept;
+        size_t get_entity(size_t index) const noexcept;
+        size_t get_parent(size_t index) const noexcept;
+        uint32_t get_depth(size_t index) const noexcept;
+    };
+}
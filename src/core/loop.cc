@@ -0,0 +1,92 @@
+#include "loop.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace core;
+
+Loop::Loop(Game &game, Interface &interface, double tick_rate,
+           size_t max_ticks)
+    : game(game),
+      interface(interface),
+      tick_length(1.0 / tick_rate),
+      max_ticks(max_ticks),
+      accumulator(0),
+      tick_count(0),
+      dropped_ticks(0) {
+    if (!(tick_rate > 0) || max_ticks == 0)
+        throw std::runtime_error(
+            "Tried to create a loop without a positive tick rate!");
+    this->publish_alpha();
+}
+
+void Loop::publish_alpha() {
+    this->interface._set_tick(this->tick_length, this->get_alpha());
+}
+
+double Loop::get_tick_length() const noexcept { return this->tick_length; }
+
+double Loop::get_tick_rate() const noexcept { return 1.0 / this->tick_length; }
+
+float Loop::get_alpha() const noexcept {
+    return (float)(this->accumulator / this->tick_length);
+}
+
+size_t Loop::get_tick_count() const noexcept { return this->tick_count; }
+
+size_t Loop::get_dropped_ticks() const noexcept {
+    return this->dropped_ticks;
+}
+
+size_t Loop::advance(double elapsed, size_t limit) {
+    if (elapsed > 0) {
+        this->accumulator += elapsed;
+    }
+    size_t most =
+        limit > 0 ? std::min(limit, this->max_ticks) : this->max_ticks;
+    size_t ticks = 0;
+    while (this->accumulator >= this->tick_length && ticks < most) {
+        this->game.update(this->interface);
+        this->accumulator -= this->tick_length;
+        this->tick_count++;
+        ticks++;
+    }
+    if (ticks == this->max_ticks && this->accumulator >= this->tick_length) {
+        // too slow to catch up: keep the partial tick, drop the rest
+        size_t behind = (size_t)(this->accumulator / this->tick_length);
+        this->dropped_ticks += behind;
+        this->accumulator -= (double)behind * this->tick_length;
+    }
+    this->publish_alpha();
+    return ticks;
+}
+
+void Loop::step(size_t ticks) {
+    for (size_t i = 0; i < ticks; i++) {
+        this->game.update(this->interface);
+        this->tick_count++;
+    }
+    this->publish_alpha();
+}
+
+void Loop::render() {
+    if (this->interface.has_renderer()) {
+        this->interface.get_renderer().begin_frame();
+        this->interface.get_renderer().clear();
+    }
+    this->game.render(this->interface);
+    if (this->interface.has_renderer()) {
+        this->interface.get_renderer().end_frame();
+    }
+}
+
+void Loop::run(render::Window &window, timer::Time &time) {
+    while (window.is_open()) {
+        window.poll_inputs();
+        double elapsed = time.delta_time();
+        time._frame_complete();
+        this->advance(elapsed);
+        this->render();
+        window.swap_buffers();
+    }
+}
@@ -0,0 +1,41 @@
+// header for the fixed-timestep run loop
+
+#pragma once
+
+#include <cstddef>
+
+#include "core.h"
+
+namespace core {
+    // steps Game::update at a fixed tick rate and renders once per frame.
+    // elapsed time is accumulated and consumed in whole ticks; what's left
+    // over is handed to render through Interface::get_alpha so positions can
+    // be interpolated between the last two ticks. at most max_ticks run per
+    // frame, anything beyond that is dropped instead of falling further
+    // behind.
+    class Loop {
+        Game &game;
+        Interface &interface;
+        double tick_length;
+        size_t max_ticks;
+        double accumulator;
+        size_t tick_count;
+        size_t dropped_ticks;
+        void publish_alpha();
+
+       public:
+        Loop(Game &game, Interface &interface, double tick_rate = 60.0,
+             size_t max_ticks = 5);
+        double get_tick_length() const noexcept;
+        double get_tick_rate() const noexcept;
+        float get_alpha() const noexcept;
+        size_t get_tick_count() const noexcept;
+        size_t get_dropped_ticks() const noexcept;
+        // runs the ticks that are due, but no more than limit if it isn't 0.
+        // time held back by the limit stays accumulated for the next call.
+        size_t advance(double elapsed, size_t limit = 0);
+        void step(size_t ticks = 1);
+        void render();
+        void run(render::Window &window, timer::Time &time);
+    };
+}
@@ -0,0 +1,60 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace core;
+
+Pool::Pool(size_t block_size, size_t align, size_t blocks_per_slab)
+    : align(std::max(align, alignof(void *))),
+      blocks_per_slab(std::max<size_t>(blocks_per_slab, 1)),
+      free_list(nullptr),
+      used(0) {
+    // every block has to be able to hold the free list link
+    block_size = std::max(block_size, sizeof(void *));
+    this->block_size =
+        (block_size + this->align - 1) / this->align * this->align;
+}
+
+void Pool::grow() {
+    unsigned char *slab = (unsigned char *)::operator new(
+        this->block_size * this->blocks_per_slab,
+        std::align_val_t(this->align));
+    this->slabs.push_back(slab);
+    // link the new blocks so that they are handed out front to back
+    for (size_t i = this->blocks_per_slab; i-- > 0;) {
+        void *block = slab + i * this->block_size;
+        *(void **)block = this->free_list;
+        this->free_list = block;
+    }
+}
+
+size_t Pool::get_block_size() const noexcept { return this->block_size; }
+
+void *Pool::allocate() {
+    if (!this->free_list) {
+        this->grow();
+    }
+    void *block = this->free_list;
+    this->free_list = *(void **)block;
+    this->used++;
+    return block;
+}
+
+void Pool::deallocate(void *block) noexcept {
+    *(void **)block = this->free_list;
+    this->free_list = block;
+    this->used--;
+}
+
+size_t Pool::size() const noexcept { return this->used; }
+
+size_t Pool::capacity() const noexcept {
+    return this->slabs.size() * this->blocks_per_slab;
+}
+
+Pool::~Pool() {
+    for (unsigned char *slab : this->slabs) {
+        ::operator delete(slab, std::align_val_t(this->align));
+    }
+}
@@ -0,0 +1,32 @@
+// header for fixed-size block pools
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace core {
+    // hands out blocks of a single size carved from larger slabs. freed
+    // blocks go onto an intrusive free list and are reused first, so once a
+    // pool has grown to its working set, allocating and freeing never touch
+    // the general-purpose heap. not thread-safe.
+    class Pool {
+        size_t block_size;
+        size_t align;
+        size_t blocks_per_slab;
+        std::vector<unsigned char *> slabs;
+        void *free_list;
+        size_t used;
+        void grow();
+
+       public:
+        Pool(size_t block_size, size_t align, size_t blocks_per_slab = 256);
+        Pool(const Pool &other) = delete;
+        size_t get_block_size() const noexcept;
+        void *allocate();
+        void deallocate(void *block) noexcept;
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        ~Pool();
+    };
+}
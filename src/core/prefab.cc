@@ -0,0 +1,9 @@
+#include "prefab.h"
+
+using namespace core;
+
+Prefab::Prototypes::~Prototypes() {}
+
+Prefab::Prefab() {}
+
+size_t Prefab::size() const noexcept { return this->prototypes.size(); }
@@ -0,0 +1,125 @@
+// header for prefab templates
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "core.h"
+
+namespace core {
+    // a set of components with default values that Game::instantiate
+    // copies into many new entities at once. all instances go straight into
+    // the same archetype, so a batch only looks it up once and grows each
+    // column a single time.
+    class Prefab {
+        class Prototypes {
+           public:
+            virtual const ColumnType &get_column_type() = 0;
+            virtual void instantiate(Column &column, Game &game,
+                                     const size_t *entity_ids, size_t count,
+                                     size_t tick) = 0;
+            virtual ~Prototypes();
+        };
+
+        template <class T>
+        class TypedPrototypes : public Prototypes {
+           public:
+            bool unique;
+            std::vector<T> components;
+            TypedPrototypes(bool unique);
+            virtual const ColumnType &get_column_type();
+            virtual void instantiate(Column &column, Game &game,
+                                     const size_t *entity_ids, size_t count,
+                                     size_t tick);
+        };
+
+        std::vector<std::unique_ptr<Prototypes>> prototypes;
+        std::vector<size_t> type_keys;
+        ComponentMask tags;
+        friend class Game;
+
+       public:
+        Prefab();
+        Prefab(const Prefab &other) = delete;
+        Prefab(Prefab &&other) = default;
+        template <class T>
+        inline Prefab &add(T prototype);
+        template <class T, class... Args>
+        inline Prefab &emplace(Args &&... args);
+        template <class T>
+        inline Prefab &add_tag();
+        size_t size() const noexcept;
+    };
+}
+
+template <class T>
+core::Prefab::TypedPrototypes<T>::TypedPrototypes(bool unique)
+    : unique(unique) {}
+
+template <class T>
+const core::ColumnType &core::Prefab::TypedPrototypes<T>::get_column_type() {
+    return column_type<T>(this->unique);
+}
+
+template <class T>
+void core::Prefab::TypedPrototypes<T>::instantiate(Column &column, Game &game,
+                                                   const size_t *entity_ids,
+                                                   size_t count, size_t tick) {
+    column.reserve(column.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        void *slot = column.prepare_push();
+        if (this->unique) {
+            T *component = new (slot) T(this->components[0]);
+            component->set_entity(Entity(game, entity_ids[i]));
+        } else {
+            std::vector<T> *components =
+                new (slot) std::vector<T>(this->components);
+            for (T &component : *components) {
+                component.set_entity(Entity(game, entity_ids[i]));
+            }
+        }
+        column.commit_push(tick);
+    }
+}
+
+template <class T>
+core::Prefab &core::Prefab::add(T prototype) {
+    static_assert(std::is_base_of<Component, T>::value,
+                  "components must derive from core::Component");
+    size_t type_key = component_key<T>();
+    for (size_t i = 0; i < this->type_keys.size(); i++) {
+        if (this->type_keys[i] != type_key) {
+            continue;
+        }
+        TypedPrototypes<T> &existing =
+            *(TypedPrototypes<T> *)this->prototypes[i].get();
+        if (existing.unique)
+            throw std::runtime_error("Tried to add unique Component " +
+                                     std::string(typeid(T).name()) +
+                                     " to a prefab twice!");
+        existing.components.push_back(std::move(prototype));
+        return *this;
+    }
+    auto typed = std::make_unique<TypedPrototypes<T>>(prototype.is_unique());
+    typed->components.push_back(std::move(prototype));
+    this->type_keys.push_back(type_key);
+    this->prototypes.push_back(std::move(typed));
+    return *this;
+}
+
+template <class T, class... Args>
+core::Prefab &core::Prefab::emplace(Args &&... args) {
+    return this->add<T>(T(std::forward<Args>(args)...));
+}
+
+template <class T>
+core::Prefab &core::Prefab::add_tag() {
+    static_assert(std::is_empty<T>::value, "tags have to be empty types");
+    this->tags.set(component_key<T>());
+    return *this;
+}
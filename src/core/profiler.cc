@@ -0,0 +1,152 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "core.h"
+
+using namespace core;
+
+Profiler::Profiler()
+    : components(MAX_COMPONENT_TYPES, ProfileSample{"", 0, 0, 0, 0}),
+      frames(0),
+      frame_seconds(0),
+      report_interval(0),
+      since_report(0) {}
+
+void Profiler::add(ProfileSample &sample, size_t calls, double seconds) {
+    sample.calls += calls;
+    sample.runs++;
+    sample.seconds += seconds;
+    sample.max_seconds = std::max(sample.max_seconds, seconds);
+}
+
+void Profiler::record_component(const ColumnType &type, size_t calls,
+                                double seconds) {
+    ProfileSample &sample = this->components[type.type_key];
+    if (sample.runs == 0) {
+        sample.name = type.name;
+    }
+    add(sample, calls, seconds);
+}
+
+void Profiler::record_system(size_t index, const System &system,
+                             double seconds) {
+    // every system writes only to its own sample, so concurrently running
+    // systems don't need a lock
+    ProfileSample &sample = this->systems[index];
+    if (sample.runs == 0) {
+        sample.name = typeid(system).name();
+    }
+    add(sample, 1, seconds);
+}
+
+void Profiler::begin_frame(size_t system_count) {
+    if (this->systems.size() < system_count) {
+        this->systems.resize(system_count, ProfileSample{"", 0, 0, 0, 0});
+    }
+}
+
+void Profiler::end_frame(double frame_time, logging::Logger *logger) {
+    if (!ENABLED) {
+        return;
+    }
+    this->frames++;
+    this->frame_seconds += frame_time;
+    this->since_report += frame_time;
+    if (logger && this->report_interval > 0 &&
+        this->since_report >= this->report_interval) {
+        this->report(*logger);
+        this->reset();
+    }
+}
+
+void Profiler::set_report_interval(double seconds) noexcept {
+    this->report_interval = seconds;
+}
+
+size_t Profiler::get_frame_count() const noexcept { return this->frames; }
+
+double Profiler::get_frame_seconds() const noexcept {
+    return this->frame_seconds;
+}
+
+std::vector<ProfileSample> Profiler::get_component_samples() const {
+    std::vector<ProfileSample> samples;
+    for (const ProfileSample &sample : this->components) {
+        if (sample.runs > 0) {
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+std::vector<ProfileSample> Profiler::get_system_samples() const {
+    std::vector<ProfileSample> samples;
+    for (const ProfileSample &sample : this->systems) {
+        if (sample.runs > 0) {
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+double Profiler::estimate_subtree(Game &game, size_t entity_id) const {
+    // components are updated a column at a time, so single entities can't be
+    // timed. instead the average cost of each type is summed up over the
+    // components of the entity and all its descendants.
+    double seconds = 0;
+    std::vector<size_t> pending{entity_id};
+    while (!pending.empty()) {
+        EntityRecord &record = game.get_record(pending.back());
+        pending.pop_back();
+        for (size_t type_key = 0; type_key < MAX_COMPONENT_TYPES;
+             type_key++) {
+            const ProfileSample &sample = this->components[type_key];
+            if (record.mask.test(type_key) && sample.calls > 0) {
+                seconds += sample.seconds / (double)sample.calls;
+            }
+        }
+        pending.insert(pending.end(), record.children.begin(),
+                       record.children.end());
+    }
+    return seconds;
+}
+
+void Profiler::report(logging::Logger &logger) const {
+    std::vector<ProfileSample> samples = this->get_component_samples();
+    std::vector<ProfileSample> system_samples = this->get_system_samples();
+    samples.insert(samples.end(), system_samples.begin(),
+                   system_samples.end());
+    std::sort(samples.begin(), samples.end(),
+              [](const ProfileSample &a, const ProfileSample &b) {
+                  return a.seconds > b.seconds;
+              });
+    size_t frames = std::max<size_t>(this->frames, 1);
+    std::ostringstream header;
+    header << std::fixed << std::setprecision(3) << "profile of "
+           << this->frames << " updates, "
+           << this->frame_seconds * 1000.0 / (double)frames << " ms each";
+    logger.info(header.str());
+    for (const ProfileSample &sample : samples) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << "  " << sample.name
+             << ": " << sample.seconds * 1000.0 / (double)frames
+             << " ms/update, " << sample.max_seconds * 1000.0
+             << " ms max, " << sample.calls / frames << " calls/update";
+        logger.info(line.str());
+    }
+}
+
+void Profiler::reset() {
+    for (ProfileSample &sample : this->components) {
+        sample = ProfileSample{"", 0, 0, 0, 0};
+    }
+    for (ProfileSample &sample : this->systems) {
+        sample = ProfileSample{"", 0, 0, 0, 0};
+    }
+    this->frames = 0;
+    this->frame_seconds = 0;
+    this->since_report = 0;
+}
@@ -0,0 +1,140 @@
+// header for the per-type update profiler
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "archetype.h"
+#include "../util/logging.h"
+
+namespace core {
+    class Game;
+    class System;
+
+    struct ProfileSample {
+        std::string name;
+        size_t calls;
+        size_t runs;
+        double seconds;
+        double max_seconds;
+    };
+
+    // accumulates how often and how long the components of every type and
+    // every system were updated. measuring is compiled in only when
+    // WOODGAS_PROFILE is defined, otherwise all samples stay empty and the
+    // scopes cost nothing.
+    class Profiler {
+        std::vector<ProfileSample> components;
+        std::vector<ProfileSample> systems;
+        size_t frames;
+        double frame_seconds;
+        double report_interval;
+        double since_report;
+        static void add(ProfileSample &sample, size_t calls, double seconds);
+
+       public:
+        static constexpr bool ENABLED =
+#ifdef WOODGAS_PROFILE
+            true;
+#else
+            false;
+#endif
+
+        Profiler();
+        void record_component(const ColumnType &type, size_t calls,
+                              double seconds);
+        void record_system(size_t index, const System &system,
+                           double seconds);
+        void begin_frame(size_t system_count);
+        void end_frame(double frame_time, logging::Logger *logger);
+        void set_report_interval(double seconds) noexcept;
+        size_t get_frame_count() const noexcept;
+        double get_frame_seconds() const noexcept;
+        std::vector<ProfileSample> get_component_samples() const;
+        std::vector<ProfileSample> get_system_samples() const;
+        template <class T>
+        inline ProfileSample get_component_sample() const;
+        double estimate_subtree(Game &game, size_t entity_id) const;
+        void report(logging::Logger &logger) const;
+        void reset();
+    };
+
+    // measures the scope it lives in and hands the time to the profiler
+    class ProfileScope {
+#ifdef WOODGAS_PROFILE
+        Profiler &profiler;
+        const ColumnType *type;
+        const System *system;
+        size_t index;
+        size_t calls;
+        std::chrono::steady_clock::time_point start;
+#endif
+
+       public:
+        inline ProfileScope(Profiler &profiler, const ColumnType &type,
+                            size_t calls);
+        inline ProfileScope(Profiler &profiler, size_t index,
+                            const System &system);
+        inline ~ProfileScope();
+    };
+}
+
+template <class T>
+core::ProfileSample core::Profiler::get_component_sample() const {
+    size_t type_key = component_key<T>();
+    if (type_key < this->components.size()) {
+        return this->components[type_key];
+    }
+    return ProfileSample{typeid(T).name(), 0, 0, 0, 0};
+}
+
+#ifdef WOODGAS_PROFILE
+core::ProfileScope::ProfileScope(Profiler &profiler, const ColumnType &type,
+                                 size_t calls)
+    : profiler(profiler),
+      type(&type),
+      system(nullptr),
+      index(0),
+      calls(calls),
+      start(std::chrono::steady_clock::now()) {}
+
+core::ProfileScope::ProfileScope(Profiler &profiler, size_t index,
+                                 const System &system)
+    : profiler(profiler),
+      type(nullptr),
+      system(&system),
+      index(index),
+      calls(1),
+      start(std::chrono::steady_clock::now()) {}
+
+core::ProfileScope::~ProfileScope() {
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - this->start)
+                         .count();
+    if (this->type) {
+        this->profiler.record_component(*this->type, this->calls, seconds);
+    } else {
+        this->profiler.record_system(this->index, *this->system, seconds);
+    }
+}
+#else
+core::ProfileScope::ProfileScope(Profiler &profiler, const ColumnType &type,
+                                 size_t calls) {
+    (void)(profiler);
+    (void)(type);
+    (void)(calls);
+}
+
+core::ProfileScope::ProfileScope(Profiler &profiler, size_t index,
+                                 const System &system) {
+    (void)(profiler);
+    (void)(index);
+    (void)(system);
+}
+
+core::ProfileScope::~ProfileScope() {}
+#endif
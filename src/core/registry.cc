@@ -0,0 +1,144 @@
+#include "registry.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace core;
+
+Registry::Registry() {}
+
+void Registry::reserve(size_t count) {
+    if (count > this->free_indices.size()) {
+        this->slots.reserve(this->slots.size() + count -
+                            this->free_indices.size());
+    }
+    this->dense.reserve(this->dense.size() + count);
+}
+
+size_t Registry::create() {
+    uint32_t index;
+    if (this->free_indices.empty()) {
+        if (this->slots.size() >= NOT_ALIVE)
+            throw std::runtime_error("reached maximum amount of entities");
+        index = (uint32_t)this->slots.size();
+        this->slots.push_back(Slot{0, NOT_ALIVE, {}});
+    } else {
+        index = this->free_indices.back();
+        this->free_indices.pop_back();
+    }
+    Slot &slot = this->slots[index];
+    size_t entity_id = make_entity_id(index, slot.generation);
+    slot.dense = (uint32_t)this->dense.size();
+    // keep the children vector of the previous owner so that its capacity
+    // is reused instead of allocated again
+    std::vector<size_t> children = std::move(slot.record.children);
+    children.clear();
+    slot.record =
+        EntityRecord{0, 0, {}, false, false, 0, std::move(children)};
+    this->dense.push_back(entity_id);
+    return entity_id;
+}
+
+void Registry::restore(const std::vector<size_t> &entity_ids) {
+    // recreates exactly the given ids, so that ids stored elsewhere stay
+    // valid. only possible while no entity is alive, and never for an id
+    // older than its slot: going back a generation would bring stale
+    // handles back to life. everything is checked before anything changes.
+    if (!this->dense.empty())
+        throw std::runtime_error(
+            "Tried to restore entities, but the registry isn't empty!");
+    size_t slot_count = this->slots.size();
+    for (size_t entity_id : entity_ids) {
+        slot_count = std::max<size_t>(slot_count, entity_index(entity_id) + 1);
+    }
+    if (slot_count > NOT_ALIVE)
+        throw std::runtime_error("reached maximum amount of entities");
+    std::vector<bool> restored(slot_count, false);
+    for (size_t entity_id : entity_ids) {
+        uint32_t index = entity_index(entity_id);
+        if (restored[index])
+            throw std::runtime_error("Tried to restore the entity with id " +
+                                     std::to_string(entity_id) +
+                                     ", but it already exists!");
+        if (index < this->slots.size() &&
+            this->slots[index].generation > entity_generation(entity_id))
+            throw std::runtime_error("Tried to restore the entity with id " +
+                                     std::to_string(entity_id) +
+                                     ", but the handle is stale!");
+        restored[index] = true;
+    }
+    this->slots.resize(slot_count, Slot{0, NOT_ALIVE, {}});
+    this->dense.reserve(entity_ids.size());
+    for (size_t entity_id : entity_ids) {
+        Slot &slot = this->slots[entity_index(entity_id)];
+        slot.generation = entity_generation(entity_id);
+        slot.dense = (uint32_t)this->dense.size();
+        slot.record = EntityRecord{0, 0, {}, false, false, 0, {}};
+        this->dense.push_back(entity_id);
+    }
+    this->free_indices.clear();
+    for (size_t index = slot_count; index-- > 0;) {
+        if (this->slots[index].dense == NOT_ALIVE) {
+            this->free_indices.push_back((uint32_t)index);
+        }
+    }
+}
+
+void Registry::destroy(size_t entity_id) {
+    if (!this->contains(entity_id))
+        throw std::runtime_error("Tried to destroy the entity with id " +
+                                 std::to_string(entity_id) +
+                                 ", but it doesn't exist!");
+    uint32_t index = entity_index(entity_id);
+    Slot &slot = this->slots[index];
+    size_t moved = this->dense.back();
+    this->dense[slot.dense] = moved;
+    this->slots[entity_index(moved)].dense = slot.dense;
+    this->dense.pop_back();
+    slot.dense = NOT_ALIVE;
+    slot.generation++;
+    slot.record.children.clear();
+    this->free_indices.push_back(index);
+}
+
+bool Registry::contains(size_t entity_id) const noexcept {
+    uint32_t index = entity_index(entity_id);
+    return index < this->slots.size() &&
+           this->slots[index].dense != NOT_ALIVE &&
+           this->slots[index].generation == entity_generation(entity_id);
+}
+
+bool Registry::is_stale(size_t entity_id) const noexcept {
+    uint32_t index = entity_index(entity_id);
+    return index < this->slots.size() &&
+           this->slots[index].generation != entity_generation(entity_id);
+}
+
+EntityRecord &Registry::get(size_t entity_id) {
+    if (!this->contains(entity_id)) {
+        if (this->is_stale(entity_id))
+            throw std::runtime_error("Tried to get entity with id " +
+                                     std::to_string(entity_id) +
+                                     ", but the handle is stale!");
+        throw std::runtime_error("Tried to get entity with id " +
+                                 std::to_string(entity_id) +
+                                 ", but it doesn't exist!");
+    }
+    return this->slots[entity_index(entity_id)].record;
+}
+
+EntityRecord *Registry::find(size_t entity_id) noexcept {
+    if (!this->contains(entity_id)) {
+        return nullptr;
+    }
+    return &this->slots[entity_index(entity_id)].record;
+}
+
+const std::vector<size_t> &Registry::alive() const noexcept {
+    return this->dense;
+}
+
+size_t Registry::size() const noexcept { return this->dense.size(); }
+
+size_t Registry::capacity() const noexcept { return this->slots.size(); }
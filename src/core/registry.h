@@ -0,0 +1,67 @@
+// header for the sparse-set entity registry
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "archetype.h"
+
+namespace core {
+    // entity ids pack a 32-bit slot index (low half) with a 32-bit
+    // generation (high half). destroying an entity bumps the generation of
+    // its slot, so old ids can be told apart from the slot's new owner.
+    inline uint32_t entity_index(size_t entity_id) noexcept {
+        return (uint32_t)(entity_id & 0xFFFFFFFF);
+    }
+
+    inline uint32_t entity_generation(size_t entity_id) noexcept {
+        return (uint32_t)(entity_id >> 32);
+    }
+
+    inline size_t make_entity_id(uint32_t index, uint32_t generation) noexcept {
+        return ((size_t)generation) << 32 | (size_t)index;
+    }
+
+    struct EntityRecord {
+        size_t archetype;
+        size_t row;
+        ComponentMask mask;
+        bool root;
+        bool has_parent;
+        size_t parent;
+        std::vector<size_t> children;
+    };
+
+    // sparse set of live entities: slots are indexed directly by the id's
+    // index, live ids are kept packed in a dense array and freed slots are
+    // recycled in LIFO order.
+    class Registry {
+        static constexpr uint32_t NOT_ALIVE = 0xFFFFFFFF;
+
+        struct Slot {
+            uint32_t generation;
+            uint32_t dense;
+            EntityRecord record;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<size_t> dense;
+        std::vector<uint32_t> free_indices;
+
+       public:
+        Registry();
+        void reserve(size_t count);
+        size_t create();
+        void restore(const std::vector<size_t> &entity_ids);
+        void destroy(size_t entity_id);
+        bool contains(size_t entity_id) const noexcept;
+        bool is_stale(size_t entity_id) const noexcept;
+        EntityRecord &get(size_t entity_id);
+        EntityRecord *find(size_t entity_id) noexcept;
+        const std::vector<size_t> &alive() const noexcept;
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+    };
+}
@@ -0,0 +1,199 @@
+#include "scheduler.h"
+
+#include "core.h"
+#include "profiler.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+using namespace core;
+
+Access::Access() : exclusive(true) {}
+
+bool Access::intersects(const std::vector<size_t> &a,
+                        const std::vector<size_t> &b) noexcept {
+    auto it_a = a.begin();
+    auto it_b = b.begin();
+    while (it_a != a.end() && it_b != b.end()) {
+        if (*it_a == *it_b) {
+            return true;
+        } else if (*it_a < *it_b) {
+            it_a++;
+        } else {
+            it_b++;
+        }
+    }
+    return false;
+}
+
+void Access::insert(std::vector<size_t> &keys, size_t key) {
+    auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) {
+        keys.insert(it, key);
+    }
+}
+
+Access &Access::read(size_t type_key) {
+    this->exclusive = false;
+    this->insert(this->reads, type_key);
+    return *this;
+}
+
+Access &Access::write(size_t type_key) {
+    this->exclusive = false;
+    this->insert(this->writes, type_key);
+    return *this;
+}
+
+bool Access::is_exclusive() const noexcept { return this->exclusive; }
+
+bool Access::conflicts_with(const Access &other) const noexcept {
+    if (this->exclusive || other.exclusive) {
+        return true;
+    }
+    return intersects(this->writes, other.writes) ||
+           intersects(this->writes, other.reads) ||
+           intersects(this->reads, other.writes);
+}
+
+Scheduler::Scheduler(size_t worker_count) : pool(worker_count) {}
+
+threading::ThreadPool &Scheduler::get_thread_pool() noexcept {
+    return this->pool;
+}
+
+void Scheduler::build(Graph &graph, const std::vector<Access> &accesses) {
+    size_t count = accesses.size();
+    graph.exclusive.assign(count, false);
+    graph.dependents.assign(count, std::vector<size_t>());
+    graph.dependencies.assign(count, 0);
+    graph.remaining.reset(new std::atomic<size_t>[count]);
+    graph.main_ready.clear();
+    graph.main_ready.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        graph.exclusive[i] = accesses[i].is_exclusive();
+        for (size_t j = 0; j < i; j++) {
+            if (accesses[j].conflicts_with(accesses[i])) {
+                graph.dependents[j].push_back(i);
+                graph.dependencies[i]++;
+            }
+        }
+    }
+}
+
+void Scheduler::dispatch(Run &run, size_t index) {
+    if (run.graph->exclusive[index]) {
+        std::lock_guard<std::mutex> lock(run.main_mutex);
+        run.graph->main_ready.push_back(index);
+        return;
+    }
+    // the task only captures two words, which std::function stores without
+    // allocating
+    Run *state = &run;
+    this->pool.submit(run.group, [this, state, index]() {
+        try {
+            (*state->task)(index);
+        } catch (...) {
+            this->finish(*state, index);
+            throw;
+        }
+        this->finish(*state, index);
+    });
+}
+
+void Scheduler::finish(Run &run, size_t index) {
+    for (size_t dependent : run.graph->dependents[index]) {
+        if (--run.graph->remaining[dependent] == 0) {
+            this->dispatch(run, dependent);
+        }
+    }
+    run.finished++;
+}
+
+void Scheduler::run(Graph &graph, const std::function<void(size_t)> &task) {
+    size_t count = graph.dependencies.size();
+    if (count == 0) {
+        return;
+    }
+    Run run;
+    run.graph = &graph;
+    run.task = &task;
+    run.finished = 0;
+    graph.main_ready.clear();
+    for (size_t i = 0; i < count; i++) {
+        graph.remaining[i] = graph.dependencies[i];
+    }
+    std::exception_ptr main_error;
+    for (size_t i = 0; i < count; i++) {
+        if (graph.dependencies[i] == 0) {
+            this->dispatch(run, i);
+        }
+    }
+    while (run.finished < count) {
+        size_t index = count;
+        {
+            std::lock_guard<std::mutex> lock(run.main_mutex);
+            if (!graph.main_ready.empty()) {
+                index = graph.main_ready.back();
+                graph.main_ready.pop_back();
+            }
+        }
+        if (index < count) {
+            try {
+                task(index);
+            } catch (...) {
+                if (!main_error) {
+                    main_error = std::current_exception();
+                }
+            }
+            this->finish(run, index);
+        } else if (!this->pool.run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+    this->pool.wait(run.group);
+    if (main_error) {
+        std::rethrow_exception(main_error);
+    }
+}
+
+void Scheduler::run(const std::vector<Access> &accesses,
+                    const std::function<void(size_t)> &task) {
+    Graph graph;
+    build(graph, accesses);
+    this->run(graph, task);
+}
+
+void Scheduler::run(std::vector<std::unique_ptr<System>> &systems, Game &game,
+                    Interface &interface, size_t first_tick) {
+    bool changed = systems.size() != this->graph_systems.size();
+    for (size_t i = 0; !changed && i < systems.size(); i++) {
+        changed = systems[i].get() != this->graph_systems[i];
+    }
+    if (changed) {
+        std::vector<Access> accesses;
+        this->graph_systems.clear();
+        for (auto &system : systems) {
+            accesses.push_back(system->get_access());
+            this->graph_systems.push_back(system.get());
+        }
+        build(this->system_graph, accesses);
+    }
+    Profiler &profiler = game.get_profiler();
+    // everything the task needs sits behind one pointer, so building the
+    // std::function doesn't allocate either
+    struct Context {
+        Profiler &profiler;
+        std::vector<std::unique_ptr<System>> &systems;
+        Game &game;
+        Interface &interface;
+        size_t first_tick;
+    } context{profiler, systems, game, interface, first_tick};
+    this->run(this->system_graph, [&context](size_t system) {
+        ProfileScope scope(context.profiler, system, *context.systems[system]);
+        SystemScope tick(context.game, *context.systems[system],
+                         context.first_tick + system);
+        context.systems[system]->update(context.game, context.interface);
+    });
+}
@@ -0,0 +1,98 @@
+// header for scheduling systems across threads
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "archetype.h"
+#include "../util/thread_pool.h"
+
+namespace core {
+    class Game;
+    class Interface;
+    class System;
+
+    // the component types a system reads and writes. systems that don't
+    // declare anything are exclusive: they run alone, on the thread calling
+    // Game::update, which is what anything touching the renderer needs.
+    class Access {
+        bool exclusive;
+        std::vector<size_t> reads;
+        std::vector<size_t> writes;
+        static bool intersects(const std::vector<size_t> &a,
+                               const std::vector<size_t> &b) noexcept;
+        void insert(std::vector<size_t> &keys, size_t key);
+
+       public:
+        Access();
+        Access &read(size_t type_key);
+        Access &write(size_t type_key);
+        template <class T>
+        inline Access &read();
+        template <class T>
+        inline Access &write();
+        bool is_exclusive() const noexcept;
+        bool conflicts_with(const Access &other) const noexcept;
+    };
+
+    // runs the systems of a frame as a dependency graph: a system depends on
+    // every earlier system whose access conflicts with its own, everything
+    // else may run concurrently on the thread pool. the same graph orders
+    // the component inits of Game::init. the graph of the systems is built
+    // once and only rebuilt when the set of systems changes, so get_access
+    // is expected to return the same access every frame.
+    class Scheduler {
+        // the counters and the ready list are reused by every run of the
+        // graph, so running a cached graph doesn't allocate
+        struct Graph {
+            std::vector<bool> exclusive;
+            std::vector<std::vector<size_t>> dependents;
+            std::vector<size_t> dependencies;
+            std::unique_ptr<std::atomic<size_t>[]> remaining;
+            std::vector<size_t> main_ready;
+        };
+
+        // state of a single run, shared by its tasks
+        struct Run {
+            Graph *graph;
+            const std::function<void(size_t)> *task;
+            threading::TaskGroup group;
+            std::atomic<size_t> finished;
+            std::mutex main_mutex;
+        };
+
+        threading::ThreadPool pool;
+        Graph system_graph;
+        std::vector<System *> graph_systems;
+
+        static void build(Graph &graph, const std::vector<Access> &accesses);
+        void run(Graph &graph, const std::function<void(size_t)> &task);
+        void dispatch(Run &run, size_t index);
+        void finish(Run &run, size_t index);
+
+       public:
+        explicit Scheduler(size_t worker_count);
+        threading::ThreadPool &get_thread_pool() noexcept;
+        void run(const std::vector<Access> &accesses,
+                 const std::function<void(size_t)> &task);
+        // the i-th system runs at first_tick + i, see SystemScope
+        void run(std::vector<std::unique_ptr<System>> &systems, Game &game,
+                 Interface &interface, size_t first_tick);
+    };
+}
+
+template <class T>
+core::Access &core::Access::read() {
+    return this->read(component_key<T>());
+}
+
+template <class T>
+core::Access &core::Access::write() {
+    return this->write(component_key<T>());
+}
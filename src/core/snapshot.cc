@@ -0,0 +1,282 @@
+#include "snapshot.h"
+
+#include <fstream>
+#include <iterator>
+
+using namespace core;
+
+namespace {
+    const char MAGIC[4] = {'W', 'G', 'S', 'N'};
+
+    enum EntityFlags : uint8_t { ROOT = 2, HAS_PARENT = 4 };
+}
+
+SnapshotWriter::SnapshotWriter(std::vector<unsigned char> &data)
+    : data(data) {}
+
+void SnapshotWriter::write_bytes(const void *bytes, size_t size) {
+    const unsigned char *begin = (const unsigned char *)bytes;
+    this->data.insert(this->data.end(), begin, begin + size);
+}
+
+unsigned char *SnapshotWriter::extend(size_t size) {
+    this->data.resize(this->data.size() + size);
+    return this->data.data() + this->data.size() - size;
+}
+
+void SnapshotWriter::write_string(const std::string &value) {
+    this->write<uint64_t>(value.size());
+    this->write_bytes(value.data(), value.size());
+}
+
+size_t SnapshotWriter::size() const noexcept { return this->data.size(); }
+
+SnapshotReader::SnapshotReader(const unsigned char *data, size_t length)
+    : data(data), length(length), position(0) {}
+
+void SnapshotReader::read_bytes(void *bytes, size_t size) {
+    if (size > this->length - this->position)
+        throw std::runtime_error(
+            "Tried to read past the end of the snapshot!");
+    std::memcpy(bytes, this->data + this->position, size);
+    this->position += size;
+}
+
+const unsigned char *SnapshotReader::take(size_t size) {
+    if (size > this->length - this->position)
+        throw std::runtime_error(
+            "Tried to read past the end of the snapshot!");
+    const unsigned char *bytes = this->data + this->position;
+    this->position += size;
+    return bytes;
+}
+
+std::string SnapshotReader::read_string() {
+    size_t size = (size_t)this->read<uint64_t>();
+    if (size > this->length - this->position)
+        throw std::runtime_error(
+            "Tried to read past the end of the snapshot!");
+    std::string value((const char *)this->data + this->position, size);
+    this->position += size;
+    return value;
+}
+
+bool SnapshotReader::at_end() const noexcept {
+    return this->position == this->length;
+}
+
+Snapshots::Snapshots() : type_indices(MAX_COMPONENT_TYPES, (size_t)-1) {
+    this->add_tag<Disabled>("core::Disabled");
+}
+
+void Snapshots::add_type(Type type) {
+    for (const Type &other : this->types) {
+        if (other.name == type.name || other.type_key == type.type_key)
+            throw std::runtime_error("Tried to add snapshot type " +
+                                     type.name + ", but it already exists!");
+    }
+    this->type_indices[type.type_key] = this->types.size();
+    this->types.push_back(std::move(type));
+}
+
+const Snapshots::Type &Snapshots::get_type(size_t type_key) {
+    if (this->type_indices[type_key] == (size_t)-1)
+        throw std::runtime_error(
+            "Tried to save a component type that wasn't added to the "
+            "snapshot types!");
+    return this->types[this->type_indices[type_key]];
+}
+
+const Snapshots::Type &Snapshots::find_type(const std::string &name) {
+    for (const Type &type : this->types) {
+        if (type.name == name) {
+            return type;
+        }
+    }
+    throw std::runtime_error("Tried to load snapshot type " + name +
+                             ", but it wasn't added!");
+}
+
+std::vector<unsigned char> Snapshots::save(Game &game) {
+    game.check_unlocked("save a snapshot");
+    std::vector<unsigned char> data;
+    SnapshotWriter writer(data);
+    writer.write_bytes(MAGIC, sizeof(MAGIC));
+    writer.write<uint32_t>(SNAPSHOT_VERSION);
+
+    const std::vector<size_t> &alive = game.entities.alive();
+    writer.write<uint64_t>(alive.size());
+    for (size_t entity_id : alive) {
+        EntityRecord &record = game.entities.get(entity_id);
+        uint8_t flags = (uint8_t)((record.root ? ROOT : 0) |
+                                  (record.has_parent ? HAS_PARENT : 0));
+        writer.write<uint64_t>(entity_id);
+        writer.write<uint8_t>(flags);
+        writer.write<uint64_t>(record.has_parent ? record.parent : 0);
+    }
+
+    // components are written archetype by archetype and column by column,
+    // so a whole column can be copied in one go
+    size_t archetype_count = 0;
+    for (auto &archetype : game.archetypes) {
+        archetype_count += archetype->size() > 0;
+    }
+    writer.write<uint64_t>(archetype_count);
+    for (auto &archetype : game.archetypes) {
+        size_t rows = archetype->size();
+        if (rows == 0) {
+            continue;
+        }
+        std::vector<Column> &columns = archetype->get_columns();
+        writer.write<uint64_t>(columns.size());
+        for (Column &column : columns) {
+            const Type &type = this->get_type(column.get_type().type_key);
+            writer.write_string(type.name);
+            writer.write<uint8_t>(column.get_type().unique);
+        }
+        // disabling an entity is a tag as well, so this also saves which
+        // entities are active
+        const ComponentMask &tags = archetype->get_tags();
+        writer.write<uint64_t>(tags.count());
+        for (size_t type_key = 0; type_key < MAX_COMPONENT_TYPES; type_key++) {
+            if (tags.test(type_key)) {
+                writer.write_string(this->get_type(type_key).name);
+            }
+        }
+        writer.write<uint64_t>(rows);
+        unsigned char *out = writer.extend(rows * sizeof(uint64_t));
+        for (size_t row = 0; row < rows; row++) {
+            uint64_t entity_id = archetype->get_entity(row);
+            std::memcpy(out + row * sizeof(uint64_t), &entity_id,
+                        sizeof(uint64_t));
+        }
+        for (Column &column : columns) {
+            this->get_type(column.get_type().type_key).save(column, writer);
+        }
+    }
+    return data;
+}
+
+void Snapshots::load(Game &game, const std::vector<unsigned char> &data) {
+    // loading into a game that already has entities would have to remap
+    // ids, so snapshots only load into empty games. if loading fails half
+    // way through, the game has to be thrown away.
+    game.check_unlocked("load a snapshot");
+    if (game.entities.size() > 0)
+        throw std::runtime_error(
+            "Tried to load a snapshot into a game that already has "
+            "entities!");
+    SnapshotReader reader(data.data(), data.size());
+    char magic[sizeof(MAGIC)];
+    reader.read_bytes(magic, sizeof(magic));
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw std::runtime_error("Tried to load a snapshot, but it isn't one!");
+    uint32_t version = reader.read<uint32_t>();
+    if (version != SNAPSHOT_VERSION)
+        throw std::runtime_error("Tried to load a snapshot of version " +
+                                 std::to_string(version) +
+                                 ", but only version " +
+                                 std::to_string(SNAPSHOT_VERSION) +
+                                 " is supported!");
+
+    size_t entity_count = (size_t)reader.read<uint64_t>();
+    std::vector<size_t> ids;
+    std::vector<uint8_t> flags;
+    std::vector<size_t> parents;
+    for (size_t i = 0; i < entity_count; i++) {
+        ids.push_back((size_t)reader.read<uint64_t>());
+        flags.push_back(reader.read<uint8_t>());
+        parents.push_back((size_t)reader.read<uint64_t>());
+    }
+    game.entities.restore(ids);
+    for (size_t i = 0; i < entity_count; i++) {
+        EntityRecord &record = game.entities.get(ids[i]);
+        record.root = flags[i] & ROOT;
+        record.has_parent = flags[i] & HAS_PARENT;
+        record.parent = parents[i];
+    }
+    for (size_t i = 0; i < entity_count; i++) {
+        if (flags[i] & HAS_PARENT) {
+            game.get_record(parents[i]).children.push_back(ids[i]);
+        }
+    }
+
+    size_t archetype_count = (size_t)reader.read<uint64_t>();
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < archetype_count; i++) {
+        size_t column_count = (size_t)reader.read<uint64_t>();
+        std::vector<const Type *> types;
+        std::vector<const ColumnType *> column_types;
+        for (size_t j = 0; j < column_count; j++) {
+            const Type &type = this->find_type(reader.read_string());
+            types.push_back(&type);
+            if (!type.column_type)
+                throw std::runtime_error("Tried to load tag " + type.name +
+                                         " as a component!");
+            column_types.push_back(type.column_type(reader.read<uint8_t>()));
+        }
+        ComponentMask tags;
+        size_t tag_count = (size_t)reader.read<uint64_t>();
+        for (size_t j = 0; j < tag_count; j++) {
+            const Type &type = this->find_type(reader.read_string());
+            if (type.column_type)
+                throw std::runtime_error("Tried to load component " +
+                                         type.name + " as a tag!");
+            tags.set(type.type_key);
+        }
+        size_t target = game.find_archetype(column_types, tags);
+        Archetype &archetype = *game.archetypes[target];
+        for (const ColumnType *column_type : column_types) {
+            if (!archetype.has_column(column_type->type_key) ||
+                &archetype.get_column(column_type->type_key).get_type() !=
+                column_type)
+                throw std::runtime_error(
+                    "Tried to load Component " +
+                    std::string(column_type->name) +
+                    ", but it's stored differently in this game!");
+        }
+        size_t row_count = (size_t)reader.read<uint64_t>();
+        const unsigned char *in = reader.take(row_count * sizeof(uint64_t));
+        rows.resize(row_count);
+        for (size_t row = 0; row < row_count; row++) {
+            uint64_t entity_id;
+            std::memcpy(&entity_id, in + row * sizeof(uint64_t),
+                        sizeof(uint64_t));
+            rows[row] = (size_t)entity_id;
+        }
+        archetype.reserve(archetype.size() + rows.size());
+        for (size_t entity_id : rows) {
+            EntityRecord &record = game.get_record(entity_id);
+            record.archetype = target;
+            record.row = archetype.push_entity(entity_id);
+            record.mask = archetype.get_mask();
+        }
+        for (const Type *type : types) {
+            type->load(archetype.get_column(type->type_key), reader, game, rows,
+                       game.tick);
+        }
+    }
+    if (!reader.at_end())
+        throw std::runtime_error(
+            "Tried to load a snapshot, but there is data left over!");
+    game.structure_version++;
+}
+
+void Snapshots::save_file(Game &game, const std::string &path) {
+    std::vector<unsigned char> data = this->save(game);
+    std::ofstream out_file(path, std::ios::binary);
+    out_file.write((const char *)data.data(), (std::streamsize)data.size());
+    if (!out_file)
+        throw std::runtime_error("Tried to write snapshot " + path +
+                                 ", but it failed!");
+}
+
+void Snapshots::load_file(Game &game, const std::string &path) {
+    std::ifstream in_file(path, std::ios::binary);
+    if (!in_file)
+        throw std::runtime_error("Tried to read snapshot " + path +
+                                 ", but it doesn't exist!");
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in_file)),
+                                    std::istreambuf_iterator<char>());
+    this->load(game, data);
+}
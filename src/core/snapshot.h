@@ -0,0 +1,219 @@
+// header for binary game snapshots
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include "core.h"
+
+namespace core {
+    const uint32_t SNAPSHOT_VERSION = 2;
+
+    // appends raw values to a snapshot buffer. values are written in the
+    // machine's native byte order, snapshots aren't portable across
+    // architectures.
+    class SnapshotWriter {
+        std::vector<unsigned char> &data;
+
+       public:
+        SnapshotWriter(std::vector<unsigned char> &data);
+        void write_bytes(const void *bytes, size_t size);
+        unsigned char *extend(size_t size);
+        template <class T>
+        inline void write(const T &value);
+        void write_string(const std::string &value);
+        size_t size() const noexcept;
+    };
+
+    class SnapshotReader {
+        const unsigned char *data;
+        size_t length;
+        size_t position;
+
+       public:
+        SnapshotReader(const unsigned char *data, size_t length);
+        void read_bytes(void *bytes, size_t size);
+        const unsigned char *take(size_t size);
+        template <class T>
+        inline T read();
+        std::string read_string();
+        bool at_end() const noexcept;
+    };
+
+    // the component types a snapshot can contain, by a name that has to
+    // stay the same between saving and loading. a type is either stored in
+    // bulk, by copying a trivially copyable state member of every component
+    // and default constructing the component on load, or through a pair of
+    // save/load hooks. tags only need a name, core::Disabled is always
+    // known as "core::Disabled".
+    class Snapshots {
+        // tags have no column type and no hooks
+        struct Type {
+            std::string name;
+            size_t type_key;
+            const ColumnType *(*column_type)(bool unique);
+            std::function<void(Column &column, SnapshotWriter &writer)> save;
+            std::function<void(Column &column, SnapshotReader &reader,
+                               Game &game, const std::vector<size_t> &rows,
+                               size_t tick)>
+                load;
+        };
+
+        std::vector<Type> types;
+        std::vector<size_t> type_indices;
+        void add_type(Type type);
+        const Type &get_type(size_t type_key);
+        const Type &find_type(const std::string &name);
+
+       public:
+        Snapshots();
+        template <class T, class S>
+        inline void add(const std::string &name, S T::*state);
+        template <class T>
+        inline void add(const std::string &name,
+                        void (*save)(const T &component,
+                                     SnapshotWriter &writer),
+                        T (*load)(SnapshotReader &reader));
+        template <class T>
+        inline void add_tag(const std::string &name);
+        std::vector<unsigned char> save(Game &game);
+        void load(Game &game, const std::vector<unsigned char> &data);
+        void save_file(Game &game, const std::string &path);
+        void load_file(Game &game, const std::string &path);
+    };
+}
+
+template <class T>
+void core::SnapshotWriter::write(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be written directly");
+    this->write_bytes(&value, sizeof(T));
+}
+
+template <class T>
+T core::SnapshotReader::read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be read directly");
+    T value;
+    this->read_bytes(&value, sizeof(T));
+    return value;
+}
+
+template <class T, class S>
+void core::Snapshots::add(const std::string &name, S T::*state) {
+    static_assert(std::is_trivially_copyable<S>::value,
+                  "bulk snapshot state has to be trivially copyable");
+    static_assert(std::is_default_constructible<T>::value,
+                  "components saved in bulk have to be default "
+                  "constructible");
+    Type type;
+    type.name = name;
+    type.type_key = component_key<T>();
+    type.column_type = [](bool unique) { return &column_type<T>(unique); };
+    type.save = [state](Column &column, SnapshotWriter &writer) {
+        size_t rows = column.size();
+        if (column.get_type().unique) {
+            T *components = (T *)column.data();
+            unsigned char *out = writer.extend(rows * sizeof(S));
+            for (size_t row = 0; row < rows; row++) {
+                std::memcpy(out + row * sizeof(S), &(components[row].*state),
+                            sizeof(S));
+            }
+            return;
+        }
+        for (size_t row = 0; row < rows; row++) {
+            std::vector<T> &components = *(std::vector<T> *)column.get(row);
+            writer.write<uint64_t>(components.size());
+            for (T &component : components) {
+                writer.write_bytes(&(component.*state), sizeof(S));
+            }
+        }
+    };
+    type.load = [state](Column &column, SnapshotReader &reader, Game &game,
+                        const std::vector<size_t> &rows, size_t tick) {
+        column.reserve(column.size() + rows.size());
+        const unsigned char *in = nullptr;
+        if (column.get_type().unique) {
+            in = reader.take(rows.size() * sizeof(S));
+        }
+        for (size_t entity_id : rows) {
+            if (column.get_type().unique) {
+                T *component = new (column.prepare_push()) T();
+                std::memcpy(&(component->*state), in, sizeof(S));
+                component->set_entity(Entity(game, entity_id));
+                in += sizeof(S);
+            } else {
+                std::vector<T> components((size_t)reader.read<uint64_t>());
+                for (T &component : components) {
+                    reader.read_bytes(&(component.*state), sizeof(S));
+                    component.set_entity(Entity(game, entity_id));
+                }
+                new (column.prepare_push())
+                    std::vector<T>(std::move(components));
+            }
+            column.commit_push(tick);
+        }
+    };
+    this->add_type(std::move(type));
+}
+
+template <class T>
+void core::Snapshots::add(const std::string &name,
+                          void (*save)(const T &component,
+                                       SnapshotWriter &writer),
+                          T (*load)(SnapshotReader &reader)) {
+    Type type;
+    type.name = name;
+    type.type_key = component_key<T>();
+    type.column_type = [](bool unique) { return &column_type<T>(unique); };
+    type.save = [save](Column &column, SnapshotWriter &writer) {
+        size_t rows = column.size();
+        for (size_t row = 0; row < rows; row++) {
+            if (column.get_type().unique) {
+                save(*(T *)column.get(row), writer);
+                continue;
+            }
+            std::vector<T> &components = *(std::vector<T> *)column.get(row);
+            writer.write<uint64_t>(components.size());
+            for (T &component : components) {
+                save(component, writer);
+            }
+        }
+    };
+    type.load = [load](Column &column, SnapshotReader &reader, Game &game,
+                       const std::vector<size_t> &rows, size_t tick) {
+        column.reserve(column.size() + rows.size());
+        for (size_t entity_id : rows) {
+            if (column.get_type().unique) {
+                T component = load(reader);
+                component.set_entity(Entity(game, entity_id));
+                new (column.prepare_push()) T(std::move(component));
+            } else {
+                std::vector<T> components;
+                size_t count = (size_t)reader.read<uint64_t>();
+                for (size_t i = 0; i < count; i++) {
+                    components.push_back(load(reader));
+                    components.back().set_entity(Entity(game, entity_id));
+                }
+                new (column.prepare_push())
+                    std::vector<T>(std::move(components));
+            }
+            column.commit_push(tick);
+        }
+    };
+    this->add_type(std::move(type));
+}
+
+template <class T>
+void core::Snapshots::add_tag(const std::string &name) {
+    static_assert(std::is_empty<T>::value, "tags have to be empty types");
+    this->add_type(Type{name, component_key<T>(), nullptr, {}, {}});
+}
@@ -0,0 +1,434 @@
+#include "spatial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace core;
+
+namespace {
+    bool overlaps(const AABB &a, const AABB &b) noexcept {
+        return a.min_x <= b.max_x && b.min_x <= a.max_x &&
+               a.min_y <= b.max_y && b.min_y <= a.max_y;
+    }
+
+    // slab test, returns the distance at which the ray enters the box or a
+    // negative value if it misses it within max_distance
+    float intersect(const AABB &box, float x, float y, float dx, float dy,
+                    float max_distance) noexcept {
+        float t_min = 0;
+        float t_max = max_distance;
+        const float origin[2] = {x, y};
+        const float direction[2] = {dx, dy};
+        const float box_min[2] = {box.min_x, box.min_y};
+        const float box_max[2] = {box.max_x, box.max_y};
+        for (size_t axis = 0; axis < 2; axis++) {
+            if (direction[axis] == 0) {
+                if (origin[axis] < box_min[axis] ||
+                    origin[axis] > box_max[axis]) {
+                    return -1;
+                }
+                continue;
+            }
+            float t1 = (box_min[axis] - origin[axis]) / direction[axis];
+            float t2 = (box_max[axis] - origin[axis]) / direction[axis];
+            if (t1 > t2) {
+                std::swap(t1, t2);
+            }
+            t_min = std::max(t_min, t1);
+            t_max = std::min(t_max, t2);
+            if (t_min > t_max) {
+                return -1;
+            }
+        }
+        return t_min;
+    }
+}
+
+SpatialIndex::SpatialIndex(float cell_size) : cell_size(cell_size) {
+    if (!(cell_size > 0))
+        throw std::runtime_error("the cell size has to be positive");
+}
+
+uint64_t SpatialIndex::cell_key(int32_t x, int32_t y) noexcept {
+    return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+}
+
+int32_t SpatialIndex::cell_coordinate(float position) const noexcept {
+    float cell = std::floor(position / this->cell_size);
+    // positions beyond the int32 range all end up in the outermost cells
+    if (!(cell > (float)std::numeric_limits<int32_t>::min())) {
+        return std::numeric_limits<int32_t>::min();
+    }
+    if (!(cell < (float)std::numeric_limits<int32_t>::max())) {
+        return std::numeric_limits<int32_t>::max();
+    }
+    return (int32_t)cell;
+}
+
+SpatialIndex::CellRange SpatialIndex::cell_range(
+    const AABB &bounds) const noexcept {
+    return CellRange{this->cell_coordinate(bounds.min_x),
+                     this->cell_coordinate(bounds.min_y),
+                     this->cell_coordinate(bounds.max_x),
+                     this->cell_coordinate(bounds.max_y)};
+}
+
+template <class F>
+void SpatialIndex::each_cell(const CellRange &range, F function) const {
+    int64_t width = (int64_t)range.max_x - range.min_x + 1;
+    int64_t height = (int64_t)range.max_y - range.min_y + 1;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    if ((uint64_t)(width * height) > this->cells.size()) {
+        // the area covers more cells than are occupied, so it's cheaper to
+        // go through the occupied ones
+        for (auto &cell : this->cells) {
+            int32_t x = (int32_t)(uint32_t)(cell.first >> 32);
+            int32_t y = (int32_t)(uint32_t)cell.first;
+            if (x >= range.min_x && x <= range.max_x && y >= range.min_y &&
+                y <= range.max_y) {
+                function(x, y, cell.second);
+            }
+        }
+        return;
+    }
+    for (int64_t y = range.min_y; y <= range.max_y; y++) {
+        for (int64_t x = range.min_x; x <= range.max_x; x++) {
+            auto it = this->cells.find(cell_key((int32_t)x, (int32_t)y));
+            if (it != this->cells.end()) {
+                function((int32_t)x, (int32_t)y, it->second);
+            }
+        }
+    }
+}
+
+void SpatialIndex::link(uint32_t entry, const CellRange &range) {
+    for (int64_t y = range.min_y; y <= range.max_y; y++) {
+        for (int64_t x = range.min_x; x <= range.max_x; x++) {
+            this->cells[cell_key((int32_t)x, (int32_t)y)].push_back(entry);
+        }
+    }
+}
+
+void SpatialIndex::unlink(uint32_t entry, const CellRange &range) {
+    for (int64_t y = range.min_y; y <= range.max_y; y++) {
+        for (int64_t x = range.min_x; x <= range.max_x; x++) {
+            auto it = this->cells.find(cell_key((int32_t)x, (int32_t)y));
+            if (it == this->cells.end()) {
+                continue;
+            }
+            std::vector<uint32_t> &cell = it->second;
+            auto pos = std::find(cell.begin(), cell.end(), entry);
+            if (pos != cell.end()) {
+                *pos = cell.back();
+                cell.pop_back();
+            }
+            if (cell.empty()) {
+                this->cells.erase(it);
+            }
+        }
+    }
+}
+
+float SpatialIndex::get_cell_size() const noexcept { return this->cell_size; }
+
+void SpatialIndex::insert(size_t entity_id, const AABB &bounds) {
+    if (this->lookup.count(entity_id))
+        throw std::runtime_error("Tried to insert entity with id " +
+                                 std::to_string(entity_id) +
+                                 " into the spatial index, but it already "
+                                 "is in there!");
+    uint32_t entry;
+    CellRange range = this->cell_range(bounds);
+    if (this->free_entries.empty()) {
+        entry = (uint32_t)this->entries.size();
+        this->entries.push_back(Entry{entity_id, bounds, range});
+    } else {
+        entry = this->free_entries.back();
+        this->free_entries.pop_back();
+        this->entries[entry] = Entry{entity_id, bounds, range};
+    }
+    this->lookup.insert({entity_id, entry});
+    this->link(entry, range);
+}
+
+void SpatialIndex::update(size_t entity_id, const AABB &bounds) {
+    auto it = this->lookup.find(entity_id);
+    if (it == this->lookup.end())
+        throw std::runtime_error("Tried to update entity with id " +
+                                 std::to_string(entity_id) +
+                                 " in the spatial index, but it doesn't "
+                                 "exist!");
+    Entry &entry = this->entries[it->second];
+    CellRange range = this->cell_range(bounds);
+    if (range.min_x != entry.cells.min_x || range.min_y != entry.cells.min_y ||
+        range.max_x != entry.cells.max_x || range.max_y != entry.cells.max_y) {
+        this->unlink(it->second, entry.cells);
+        this->link(it->second, range);
+        entry.cells = range;
+    }
+    entry.bounds = bounds;
+}
+
+void SpatialIndex::remove(size_t entity_id) {
+    auto it = this->lookup.find(entity_id);
+    if (it == this->lookup.end())
+        throw std::runtime_error("Tried to remove entity with id " +
+                                 std::to_string(entity_id) +
+                                 " from the spatial index, but it doesn't "
+                                 "exist!");
+    this->unlink(it->second, this->entries[it->second].cells);
+    this->free_entries.push_back(it->second);
+    this->lookup.erase(it);
+}
+
+bool SpatialIndex::contains(size_t entity_id) const noexcept {
+    return this->lookup.count(entity_id) > 0;
+}
+
+const AABB &SpatialIndex::get_bounds(size_t entity_id) const {
+    auto it = this->lookup.find(entity_id);
+    if (it == this->lookup.end())
+        throw std::runtime_error("Tried to get the bounds of entity with id " +
+                                 std::to_string(entity_id) +
+                                 ", but it isn't in the spatial index!");
+    return this->entries[it->second].bounds;
+}
+
+size_t SpatialIndex::size() const noexcept { return this->lookup.size(); }
+
+size_t SpatialIndex::get_cell_count() const noexcept {
+    return this->cells.size();
+}
+
+void SpatialIndex::get_entities(std::vector<size_t> &out) const {
+    for (auto &entry : this->lookup) {
+        out.push_back(entry.first);
+    }
+}
+
+void SpatialIndex::clear() {
+    this->entries.clear();
+    this->free_entries.clear();
+    this->lookup.clear();
+    this->cells.clear();
+}
+
+void SpatialIndex::query_aabb(const AABB &area,
+                              std::vector<size_t> &out) const {
+    CellRange range = this->cell_range(area);
+    this->each_cell(range, [&](int32_t x, int32_t y,
+                               const std::vector<uint32_t> &cell) {
+        for (uint32_t index : cell) {
+            const Entry &entry = this->entries[index];
+            // entries spanning several cells are only reported from the
+            // first cell they share with the area
+            if (x != std::max(entry.cells.min_x, range.min_x) ||
+                y != std::max(entry.cells.min_y, range.min_y)) {
+                continue;
+            }
+            if (overlaps(entry.bounds, area)) {
+                out.push_back(entry.entity);
+            }
+        }
+    });
+}
+
+void SpatialIndex::query_radius(float x, float y, float radius,
+                                std::vector<size_t> &out) const {
+    AABB area{x - radius, y - radius, x + radius, y + radius};
+    CellRange range = this->cell_range(area);
+    this->each_cell(range, [&](int32_t cell_x, int32_t cell_y,
+                               const std::vector<uint32_t> &cell) {
+        for (uint32_t index : cell) {
+            const Entry &entry = this->entries[index];
+            if (cell_x != std::max(entry.cells.min_x, range.min_x) ||
+                cell_y != std::max(entry.cells.min_y, range.min_y)) {
+                continue;
+            }
+            // distance from the center to the closest point of the box
+            float nearest_x =
+                std::min(std::max(x, entry.bounds.min_x), entry.bounds.max_x);
+            float nearest_y =
+                std::min(std::max(y, entry.bounds.min_y), entry.bounds.max_y);
+            float distance_x = nearest_x - x;
+            float distance_y = nearest_y - y;
+            if (distance_x * distance_x + distance_y * distance_y <=
+                radius * radius) {
+                out.push_back(entry.entity);
+            }
+        }
+    });
+}
+
+void SpatialIndex::raycast(float x, float y, float dx, float dy,
+                           float max_distance,
+                           std::vector<RayHit> &out) const {
+    if (!std::isfinite(max_distance))
+        throw std::runtime_error(
+            "Tried to cast a ray, but its length isn't finite!");
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0 || max_distance < 0) {
+        return;
+    }
+    dx /= length;
+    dy /= length;
+    size_t first = out.size();
+    // walk the cells along the ray in order (Amanatides & Woo)
+    const float infinity = std::numeric_limits<float>::infinity();
+    int32_t cell_x = this->cell_coordinate(x);
+    int32_t cell_y = this->cell_coordinate(y);
+    int32_t step_x = dx > 0 ? 1 : -1;
+    int32_t step_y = dy > 0 ? 1 : -1;
+    float next_x = (float)(cell_x + (dx > 0 ? 1 : 0)) * this->cell_size;
+    float next_y = (float)(cell_y + (dy > 0 ? 1 : 0)) * this->cell_size;
+    float t_max_x = dx != 0 ? (next_x - x) / dx : infinity;
+    float t_max_y = dy != 0 ? (next_y - y) / dy : infinity;
+    float t_delta_x = dx != 0 ? this->cell_size / std::fabs(dx) : infinity;
+    float t_delta_y = dy != 0 ? this->cell_size / std::fabs(dy) : infinity;
+    float t = 0;
+    while (t <= max_distance) {
+        auto it = this->cells.find(cell_key(cell_x, cell_y));
+        if (it != this->cells.end()) {
+            for (uint32_t index : it->second) {
+                const Entry &entry = this->entries[index];
+                float distance =
+                    intersect(entry.bounds, x, y, dx, dy, max_distance);
+                if (distance >= 0) {
+                    out.push_back(RayHit{entry.entity, distance});
+                }
+            }
+        }
+        if (t_max_x < t_max_y) {
+            t = t_max_x;
+            t_max_x += t_delta_x;
+            cell_x += step_x;
+        } else {
+            t = t_max_y;
+            t_max_y += t_delta_y;
+            cell_y += step_y;
+        }
+    }
+    // boxes spanning several cells were hit once per cell
+    auto begin = out.begin() + (std::ptrdiff_t)first;
+    std::sort(begin, out.end(), [](const RayHit &a, const RayHit &b) {
+        return a.entity < b.entity;
+    });
+    out.erase(std::unique(begin, out.end(),
+                          [](const RayHit &a, const RayHit &b) {
+                              return a.entity == b.entity;
+                          }),
+              out.end());
+    std::sort(out.begin() + (std::ptrdiff_t)first, out.end(),
+              [](const RayHit &a, const RayHit &b) {
+                  return a.distance < b.distance;
+              });
+}
+
+SpatialComponent::SpatialComponent() : SpatialComponent(0, 0) {}
+
+SpatialComponent::SpatialComponent(float half_width, float half_height)
+    : half_width(half_width), half_height(half_height) {}
+
+bool SpatialComponent::is_unique() { return true; }
+
+float SpatialComponent::get_half_width() const noexcept {
+    return this->half_width;
+}
+
+float SpatialComponent::get_half_height() const noexcept {
+    return this->half_height;
+}
+
+void SpatialComponent::set_extents(float half_width, float half_height) {
+    this->half_width = half_width;
+    this->half_height = half_height;
+    this->entity.mark_changed<SpatialComponent>();
+}
+
+SpatialSystem::SpatialSystem(float cell_size)
+    : index(cell_size), structure_version((size_t)-1) {}
+
+SpatialIndex &SpatialSystem::get_index() noexcept { return this->index; }
+
+AABB SpatialSystem::world_bounds(TransformComponent &transform,
+                                 SpatialComponent &spatial) {
+    // bounds of the extents after rotating and scaling them with the world
+    // matrix
+    const Affine2D &world = transform.get_world();
+    float half_width = std::fabs(world[0]) * spatial.get_half_width() +
+                       std::fabs(world[2]) * spatial.get_half_height();
+    float half_height = std::fabs(world[1]) * spatial.get_half_width() +
+                        std::fabs(world[3]) * spatial.get_half_height();
+    return AABB{world[4] - half_width, world[5] - half_height,
+                world[4] + half_width, world[5] + half_height};
+}
+
+void SpatialSystem::resync(Game &game) {
+    // entities may have lost a component, been disabled or enabled again
+    this->indexed.clear();
+    this->index.get_entities(this->indexed);
+    for (size_t entity_id : this->indexed) {
+        if (!game.has_component<TransformComponent>(entity_id) ||
+            !game.has_component<SpatialComponent>(entity_id) ||
+            game.has_tag<Disabled>(entity_id)) {
+            this->index.remove(entity_id);
+        }
+    }
+    game.view<TransformComponent, SpatialComponent>().each(
+        [&](Entity entity, TransformComponent &transform,
+            SpatialComponent &spatial) {
+            if (!this->index.contains(entity.get_id())) {
+                this->index.insert(entity.get_id(),
+                                   world_bounds(transform, spatial));
+            }
+        });
+    this->structure_version = game.get_structure_version();
+}
+
+void SpatialSystem::refresh(Entity entity, TransformComponent &transform,
+                            SpatialComponent &spatial) {
+    AABB bounds = world_bounds(transform, spatial);
+    if (this->index.contains(entity.get_id())) {
+        this->index.update(entity.get_id(), bounds);
+    } else {
+        this->index.insert(entity.get_id(), bounds);
+    }
+}
+
+void SpatialSystem::init(Game &game, Interface &interface) {
+    (void)(interface);
+    this->index.clear();
+    game.view<TransformComponent, SpatialComponent>().each(
+        [&](Entity entity, TransformComponent &transform,
+            SpatialComponent &spatial) {
+            this->index.insert(entity.get_id(),
+                               world_bounds(transform, spatial));
+        });
+    this->structure_version = game.get_structure_version();
+}
+
+void SpatialSystem::update(Game &game, Interface &interface) {
+    (void)(interface);
+    if (this->structure_version != game.get_structure_version()) {
+        this->resync(game);
+    }
+    auto refresh = [&](Entity entity, TransformComponent &transform,
+                       SpatialComponent &spatial) {
+        this->refresh(entity, transform, spatial);
+    };
+    game.view<TransformComponent, SpatialComponent>()
+        .changed<TransformComponent>()
+        .each(refresh);
+    game.view<TransformComponent, SpatialComponent>()
+        .changed<SpatialComponent>()
+        .each(refresh);
+}
+
+Access SpatialSystem::get_access() {
+    return Access().read<TransformComponent>().write<SpatialComponent>();
+}
@@ -0,0 +1,114 @@
+// header for the spatial index over entity bounds
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "transform.h"
+
+namespace core {
+    struct AABB {
+        float min_x, min_y;
+        float max_x, max_y;
+    };
+
+    struct RayHit {
+        size_t entity;
+        float distance;
+    };
+
+    // uniform hash grid of axis aligned bounding boxes. every entry is
+    // listed in each cell it overlaps, only cells that hold something are
+    // stored. moving an entry only touches the grid when it enters or
+    // leaves a cell. queries don't modify the index, so several threads may
+    // query it at once as long as nobody changes it.
+    class SpatialIndex {
+        struct CellRange {
+            int32_t min_x, min_y;
+            int32_t max_x, max_y;
+        };
+
+        struct Entry {
+            size_t entity;
+            AABB bounds;
+            CellRange cells;
+        };
+
+        float cell_size;
+        std::vector<Entry> entries;
+        std::vector<uint32_t> free_entries;
+        std::unordered_map<size_t, uint32_t> lookup;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+        static uint64_t cell_key(int32_t x, int32_t y) noexcept;
+        int32_t cell_coordinate(float position) const noexcept;
+        CellRange cell_range(const AABB &bounds) const noexcept;
+        void link(uint32_t entry, const CellRange &range);
+        void unlink(uint32_t entry, const CellRange &range);
+        template <class F>
+        void each_cell(const CellRange &range, F function) const;
+
+       public:
+        explicit SpatialIndex(float cell_size = 64.0f);
+        float get_cell_size() const noexcept;
+        void insert(size_t entity_id, const AABB &bounds);
+        void update(size_t entity_id, const AABB &bounds);
+        void remove(size_t entity_id);
+        bool contains(size_t entity_id) const noexcept;
+        const AABB &get_bounds(size_t entity_id) const;
+        size_t size() const noexcept;
+        size_t get_cell_count() const noexcept;
+        void get_entities(std::vector<size_t> &out) const;
+        void clear();
+        // the queries append to out, every entity at most once
+        void query_aabb(const AABB &area, std::vector<size_t> &out) const;
+        void query_radius(float x, float y, float radius,
+                          std::vector<size_t> &out) const;
+        // hits sorted by the distance from the origin to where the ray
+        // enters the bounds. the direction doesn't have to be normalized.
+        void raycast(float x, float y, float dx, float dy, float max_distance,
+                     std::vector<RayHit> &out) const;
+    };
+
+    // half extents of an entity around the position of its transform. the
+    // SpatialSystem indexes every entity with this and a TransformComponent.
+    class SpatialComponent : public Component {
+        float half_width, half_height;
+
+       public:
+        SpatialComponent();
+        SpatialComponent(float half_width, float half_height);
+        virtual void init(Interface &interface) { (void)(interface); }
+        virtual void update(Interface &interface) { (void)(interface); }
+        virtual bool is_unique();
+        float get_half_width() const noexcept;
+        float get_half_height() const noexcept;
+        void set_extents(float half_width, float half_height);
+    };
+
+    // keeps a SpatialIndex in sync with the world matrices computed by the
+    // TransformSystem, so it has to be added after that. only entities whose
+    // transform or extents changed since its last update are re-indexed.
+    // disabled entities are left out of the index.
+    // systems querying the index while the game runs should declare read
+    // access to SpatialComponent, which orders them after this system.
+    class SpatialSystem : public System {
+        SpatialIndex index;
+        size_t structure_version;
+        std::vector<size_t> indexed;
+        static AABB world_bounds(TransformComponent &transform,
+                                 SpatialComponent &spatial);
+        void resync(Game &game);
+        void refresh(Entity entity, TransformComponent &transform,
+                     SpatialComponent &spatial);
+
+       public:
+        explicit SpatialSystem(float cell_size = 64.0f);
+        SpatialIndex &get_index() noexcept;
+        virtual void init(Game &game, Interface &interface);
+        virtual void update(Game &game, Interface &interface);
+        virtual Access get_access();
+    };
+}
@@ -0,0 +1,153 @@
+#include "transform.h"
+
+#include <cmath>
+
+using namespace core;
+
+namespace {
+    Affine2D multiply(const Affine2D &p, const Affine2D &l) {
+        return Affine2D{
+            p[0] * l[0] + p[2] * l[1],
+            p[1] * l[0] + p[3] * l[1],
+            p[0] * l[2] + p[2] * l[3],
+            p[1] * l[2] + p[3] * l[3],
+            p[0] * l[4] + p[2] * l[5] + p[4],
+            p[1] * l[4] + p[3] * l[5] + p[5],
+        };
+    }
+}
+
+TransformComponent::TransformComponent() : TransformComponent(0, 0) {}
+
+TransformComponent::TransformComponent(float x, float y, float rotation,
+                                       float scale)
+    : x(x),
+      y(y),
+      rotation(rotation),
+      scale_x(scale),
+      scale_y(scale),
+      world{1, 0, 0, 1, x, y},
+      dirty(true) {}
+
+bool TransformComponent::is_unique() { return true; }
+
+float TransformComponent::get_x() { return this->x; }
+
+float TransformComponent::get_y() { return this->y; }
+
+float TransformComponent::get_rotation() { return this->rotation; }
+
+float TransformComponent::get_scale_x() { return this->scale_x; }
+
+float TransformComponent::get_scale_y() { return this->scale_y; }
+
+void TransformComponent::set_position(float x, float y) {
+    this->x = x;
+    this->y = y;
+    this->dirty = true;
+}
+
+void TransformComponent::move(float x, float y) {
+    this->x += x;
+    this->y += y;
+    this->dirty = true;
+}
+
+void TransformComponent::set_rotation(float rotation) {
+    this->rotation = rotation;
+    this->dirty = true;
+}
+
+void TransformComponent::set_scale(float x, float y) {
+    this->scale_x = x;
+    this->scale_y = y;
+    this->dirty = true;
+}
+
+bool TransformComponent::is_dirty() const noexcept { return this->dirty; }
+
+Affine2D TransformComponent::get_local() const {
+    float c = std::cos(this->rotation);
+    float s = std::sin(this->rotation);
+    return Affine2D{
+        c * this->scale_x,  s * this->scale_x, -s * this->scale_y,
+        c * this->scale_y,  this->x,           this->y,
+    };
+}
+
+const Affine2D &TransformComponent::get_world() const noexcept {
+    return this->world;
+}
+
+float TransformComponent::get_world_x() const noexcept {
+    return this->world[4];
+}
+
+float TransformComponent::get_world_y() const noexcept {
+    return this->world[5];
+}
+
+TransformSystem::TransformSystem() : structure_version((size_t)-1) {}
+
+void TransformSystem::rebuild(Game &game) {
+    const Hierarchy &hierarchy = game.get_hierarchy();
+    std::vector<size_t> slots(hierarchy.size(), Hierarchy::NONE);
+    this->entities.clear();
+    this->transforms.clear();
+    this->parents.clear();
+    for (size_t i = 0; i < hierarchy.size(); i++) {
+        size_t parent = hierarchy.get_parent(i);
+        // entities without a transform pass their parent's down
+        size_t parent_slot = parent == Hierarchy::NONE ? Hierarchy::NONE
+                                                        : slots[parent];
+        size_t entity_id = hierarchy.get_entity(i);
+        if (!game.has_component<TransformComponent>(entity_id)) {
+            slots[i] = parent_slot;
+            continue;
+        }
+        TransformComponent &transform =
+            game.get_single_component<TransformComponent>(entity_id);
+        // the hierarchy may have changed, so recompute everything once
+        transform.dirty = true;
+        slots[i] = this->transforms.size();
+        this->entities.push_back(entity_id);
+        this->transforms.push_back(&transform);
+        this->parents.push_back(parent_slot);
+    }
+    this->changed.assign(this->transforms.size(), 0);
+    this->structure_version = game.get_structure_version();
+}
+
+void TransformSystem::init(Game &game, Interface &interface) {
+    this->update(game, interface);
+}
+
+void TransformSystem::update(Game &game, Interface &interface) {
+    (void)(interface);
+    if (this->structure_version != game.get_structure_version()) {
+        this->rebuild(game);
+    }
+    size_t count = this->transforms.size();
+    for (size_t i = 0; i < count; i++) {
+        TransformComponent &transform = *this->transforms[i];
+        size_t parent = this->parents[i];
+        bool parent_changed =
+            parent != Hierarchy::NONE && this->changed[parent];
+        if (transform.dirty || parent_changed) {
+            transform.world =
+                parent == Hierarchy::NONE
+                    ? transform.get_local()
+                    : multiply(this->transforms[parent]->world,
+                               transform.get_local());
+            transform.dirty = false;
+            this->changed[i] = 1;
+            game.mark_changed<TransformComponent>(this->entities[i]);
+        } else {
+            this->changed[i] = 0;
+        }
+    }
+}
+
+Access TransformSystem::get_access() {
+    return Access().write<TransformComponent>();
+}
@@ -0,0 +1,66 @@
+// header for hierarchical 2D transforms
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "core.h"
+
+namespace core {
+    // 2D affine matrix stored column-major as {a, b, c, d, tx, ty}
+    typedef std::array<float, 6> Affine2D;
+
+    // local position, rotation and scale of an entity relative to its
+    // parent. the world matrix is cached and only recomputed by the
+    // TransformSystem when this transform or one of its ancestors changed.
+    class TransformComponent : public Component {
+        float x, y;
+        float rotation;
+        float scale_x, scale_y;
+        Affine2D world;
+        bool dirty;
+        friend class TransformSystem;
+
+       public:
+        TransformComponent();
+        TransformComponent(float x, float y, float rotation = 0,
+                           float scale = 1);
+        virtual void init(Interface &interface) { (void)(interface); }
+        virtual void update(Interface &interface) { (void)(interface); }
+        virtual bool is_unique();
+        float get_x();
+        float get_y();
+        float get_rotation();
+        float get_scale_x();
+        float get_scale_y();
+        void set_position(float x, float y);
+        void move(float x, float y);
+        void set_rotation(float rotation);
+        void set_scale(float x, float y);
+        bool is_dirty() const noexcept;
+        Affine2D get_local() const;
+        const Affine2D &get_world() const noexcept;
+        float get_world_x() const noexcept;
+        float get_world_y() const noexcept;
+    };
+
+    // walks the flattened hierarchy front to back and recomputes the world
+    // matrices of dirty transforms and everything below them. transforms
+    // whose world matrix changed are marked as changed, so change filters
+    // see movement inherited from a parent too.
+    class TransformSystem : public System {
+        size_t structure_version;
+        std::vector<size_t> entities;
+        std::vector<TransformComponent *> transforms;
+        std::vector<size_t> parents;
+        std::vector<char> changed;
+        void rebuild(Game &game);
+
+       public:
+        TransformSystem();
+        virtual void init(Game &game, Interface &interface);
+        virtual void update(Game &game, Interface &interface);
+        virtual Access get_access();
+    };
+}
@@ -6,9 +6,20 @@
 #include <system_error>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
 
 using namespace render;
 
+namespace {
+    SpriteInstance make_sprite_instance(TextureRef &tex, Transform3D &tf) {
+        SpriteInstance instance;
+        std::memcpy(instance.transform, tf.get_data(), 16 * sizeof(float));
+        std::array<float, 4> rect = tex.get_uv_rect();
+        std::memcpy(instance.atlas, rect.data(), 4 * sizeof(float));
+        return instance;
+    }
+}
+
 Color::Color(float r, float g, float b, float a) : r(r), g(g), b(b), a(a) {}
 
 float Color::red() { return this->r; }
@@ -66,6 +77,175 @@ void Window::swap_buffers() { glfwSwapBuffers((GLFWwindow *)this->window); }
 
 void *Window::_get_window_ptr() { return this->window; }
 
+StateCache::StateCache() : issued(0), skipped(0) { this->invalidate(); }
+
+bool StateCache::count(bool changed) {
+    if (changed) {
+        this->issued++;
+    } else {
+        this->skipped++;
+    }
+    return changed;
+}
+
+void StateCache::use_program(GLuint program) {
+    if (this->count(this->program != program)) {
+        glUseProgram(program);
+        this->program = program;
+    }
+}
+
+void StateCache::bind_vertex_array(GLuint vao) {
+    if (this->count(this->vao != vao)) {
+        glBindVertexArray(vao);
+        this->vao = vao;
+    }
+}
+
+void StateCache::bind_texture(GLuint unit, GLuint texture) {
+    if (unit >= TEXTURE_UNITS)
+        throw std::runtime_error("Tried to bind a texture to unit " +
+                                 std::to_string(unit) +
+                                 ", but only " +
+                                 std::to_string(TEXTURE_UNITS) +
+                                 " units are tracked!");
+    if (this->textures[unit] == texture) {
+        this->count(false);
+        return;
+    }
+    if (this->count(this->active_unit != unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        this->active_unit = unit;
+    }
+    this->count(true);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    this->textures[unit] = texture;
+}
+
+void StateCache::set_blend(bool enabled) {
+    if (this->count(this->blend != (int)enabled)) {
+        if (enabled) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        this->blend = enabled;
+    }
+}
+
+void StateCache::set_blend_func(GLenum src, GLenum dst) {
+    if (this->count(this->blend_src != src || this->blend_dst != dst)) {
+        glBlendFunc(src, dst);
+        this->blend_src = src;
+        this->blend_dst = dst;
+    }
+}
+
+void StateCache::set_depth_test(bool enabled) {
+    if (this->count(this->depth_test != (int)enabled)) {
+        if (enabled) {
+            glEnable(GL_DEPTH_TEST);
+        } else {
+            glDisable(GL_DEPTH_TEST);
+        }
+        this->depth_test = enabled;
+    }
+}
+
+void StateCache::set_depth_func(GLenum func) {
+    if (this->count(this->depth_func != func)) {
+        glDepthFunc(func);
+        this->depth_func = func;
+    }
+}
+
+bool StateCache::change_uniform(GLint location, size_t size, bool transpose,
+                                const float *data) {
+    // uniforms belong to the bound program, so they can only be compared
+    // while it is known
+    if (location < 0) {
+        return this->count(false);
+    }
+    if (this->program == UNKNOWN) {
+        return this->count(true);
+    }
+    uint64_t key = ((uint64_t)this->program) << 32 | (uint32_t)location;
+    auto it = this->uniforms.find(key);
+    if (it != this->uniforms.end() && it->second.size == size &&
+        it->second.transpose == transpose &&
+        std::memcmp(it->second.data.data(), data, size * sizeof(float)) ==
+            0) {
+        return this->count(false);
+    }
+    UniformValue &value = this->uniforms[key];
+    value.size = size;
+    value.transpose = transpose;
+    std::memcpy(value.data.data(), data, size * sizeof(float));
+    return this->count(true);
+}
+
+void StateCache::set_uniform(GLint location, float x, float y, float z,
+                             float w) {
+    const float data[4] = {x, y, z, w};
+    if (this->change_uniform(location, 4, false, data)) {
+        glUniform4f(location, x, y, z, w);
+    }
+}
+
+void StateCache::set_uniform_matrix(GLint location, const float *data,
+                                    bool transpose) {
+    if (this->change_uniform(location, 16, transpose, data)) {
+        glUniformMatrix4fv(location, 1, transpose, data);
+    }
+}
+
+void StateCache::forget_program(GLuint program) {
+    for (auto it = this->uniforms.begin(); it != this->uniforms.end();) {
+        if ((GLuint)(it->first >> 32) == program) {
+            it = this->uniforms.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void StateCache::forget_texture(GLuint texture) {
+    // deleting a texture unbinds it from every unit
+    for (GLuint &bound : this->textures) {
+        if (bound == texture) {
+            bound = UNKNOWN;
+        }
+    }
+}
+
+void StateCache::forget_vertex_array(GLuint vao) {
+    if (this->vao == vao) {
+        this->vao = UNKNOWN;
+    }
+}
+
+void StateCache::invalidate() {
+    this->program = UNKNOWN;
+    this->vao = UNKNOWN;
+    this->active_unit = UNKNOWN;
+    this->textures.fill(UNKNOWN);
+    this->blend = -1;
+    this->blend_src = UNKNOWN;
+    this->blend_dst = UNKNOWN;
+    this->depth_test = -1;
+    this->depth_func = UNKNOWN;
+    this->uniforms.clear();
+}
+
+size_t StateCache::get_issued_calls() { return this->issued; }
+
+size_t StateCache::get_skipped_calls() { return this->skipped; }
+
+void StateCache::reset_counters() {
+    this->issued = 0;
+    this->skipped = 0;
+}
+
 AtlasEntry::AtlasEntry(size_t width, size_t height, int components,
                        const char *img_data)
     : width(width),
@@ -76,6 +256,10 @@ AtlasEntry::AtlasEntry(size_t width, size_t height, int components,
 Texture::Texture(size_t width, size_t height, int components,
                  const char *img_data, bool interpolate) {
     // TODO: use components
+    // the previous binding is restored afterwards, so a state cache that
+    // shadows the active unit stays valid
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
     glGenTextures(1, &this->texture);
     glBindTexture(GL_TEXTURE_2D, this->texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -99,13 +283,14 @@ Texture::Texture(size_t width, size_t height, int components,
             color_format = GL_RED;
             break;
         default:
+            glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
             throw std::runtime_error(
                 "impossible number of image color channels: " +
                 std::to_string(components));
     }
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)width, (GLsizei)height, 0,
                  color_format, GL_UNSIGNED_BYTE, img_data);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
 }
 
 std::vector<TextureRef> Texture::create_atlas(std::vector<AtlasEntry> entries,
@@ -157,6 +342,18 @@ TextureRef::TextureRef(Texture texture, int16_t x, int16_t y, int16_t width,
                        int16_t height)
     : texture(texture), size(width, height), offset(x, y) {}
 
+std::array<float, 4> TextureRef::get_uv_rect() const {
+    // offset and size of the texture inside its atlas in uv space
+    if (this->offset.first < 0 || this->offset.second < 0 ||
+        this->size.first < 0 || this->size.second < 0) {
+        return {0, 0, 1, 1};
+    }
+    float tw = 1.0f / (float)this->size.first;
+    float th = 1.0f / (float)this->size.second;
+    return {tw * (float)this->offset.first, th * (float)this->offset.second,
+            tw, th};
+}
+
 bool TextureRef::operator==(const TextureRef &other) const {
     if (this->texture.get_texture() != other.texture.get_texture()) {
         return false;
@@ -234,41 +431,116 @@ float *Transform3D::get_data() { return this->data.data(); }
 
 GLuint Texture::get_texture() const { return this->texture; }
 
-void Texture::cleanup() {
-    glBindTexture(GL_TEXTURE_2D, 0);
+void Texture::cleanup(StateCache *state) {
+    if (state) {
+        state->forget_texture(this->texture);
+    }
     glDeleteTextures(1, &this->texture);
 }
 
-Mesh::Mesh() {}
+Mesh::Mesh()
+    : vao(0),
+      vertex_vbo(0),
+      uv_vbo(0),
+      index_vbo(0),
+      length(0),
+      state(nullptr) {}
 
 Mesh::Mesh(std::vector<float> vertices, std::vector<float> uvs,
-           std::vector<int> indices)
-    : length((GLsizei)indices.size()) {
+           std::vector<int> indices, StateCache *state)
+    : length((GLsizei)indices.size()), state(state) {
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    this->bind();
 
     glGenBuffers(1, &this->vertex_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, this->vertex_vbo);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float),
-                 &(*vertices.begin()), GL_STATIC_DRAW);
+                 vertices.data(), GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(0);
 
     glGenBuffers(1, &this->uv_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, this->uv_vbo);
-    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(float), &(*uvs.begin()),
+    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(float), uvs.data(),
                  GL_STATIC_DRAW);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(1);
 
     glGenBuffers(1, &this->index_vbo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->index_vbo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(int),
-                 &(*indices.begin()), GL_STATIC_DRAW);
+                 indices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // the enabled attributes and the index buffer are part of the vao, so
+    // drawing the mesh only needs to bind it
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    this->unbind();
+}
+
+void Mesh::bind() {
+    if (this->state) {
+        this->state->bind_vertex_array(this->vao);
+    } else {
+        glBindVertexArray(this->vao);
+    }
+}
+
+void Mesh::unbind() {
+    // the cache knows the vao is still bound, which saves binding it again
+    // for the next draw
+    if (!this->state) {
+        glBindVertexArray(0);
+    }
 }
 
+void Mesh::update(const std::vector<float> &vertices,
+                  const std::vector<float> &uvs,
+                  const std::vector<int> &indices) {
+    // replaces the contents but keeps the vao and buffers. the index buffer
+    // binding belongs to the vao, so it has to be bound while uploading.
+    this->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, this->vertex_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float),
+                 vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, this->uv_vbo);
+    glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(float), uvs.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(int),
+                 indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->unbind();
+    this->length = (GLsizei)indices.size();
+}
+
+Mesh::Mesh(Mesh &&other) noexcept
+    : vao(other.vao),
+      vertex_vbo(other.vertex_vbo),
+      uv_vbo(other.uv_vbo),
+      index_vbo(other.index_vbo),
+      length(other.length),
+      state(other.state) {
+    other.vao = 0;
+    other.vertex_vbo = 0;
+    other.uv_vbo = 0;
+    other.index_vbo = 0;
+    other.length = 0;
+}
+
+Mesh &Mesh::operator=(Mesh &&other) noexcept {
+    if (this != &other) {
+        this->cleanup();
+        std::swap(this->vao, other.vao);
+        std::swap(this->vertex_vbo, other.vertex_vbo);
+        std::swap(this->uv_vbo, other.uv_vbo);
+        std::swap(this->index_vbo, other.index_vbo);
+        std::swap(this->length, other.length);
+        std::swap(this->state, other.state);
+    }
+    return *this;
+}
+
+Mesh::~Mesh() { this->cleanup(); }
+
 GLuint Mesh::get_vao() { return this->vao; }
 
 GLuint Mesh::get_indices() { return this->index_vbo; }
@@ -276,10 +548,220 @@ GLuint Mesh::get_indices() { return this->index_vbo; }
 GLsizei Mesh::get_length() { return this->length; }
 
 void Mesh::cleanup() {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (this->vao == 0) {
+        return;
+    }
+    if (this->state) {
+        this->state->forget_vertex_array(this->vao);
+    }
     glDeleteBuffers(1, &this->vertex_vbo);
-    glBindVertexArray(0);
+    glDeleteBuffers(1, &this->uv_vbo);
+    glDeleteBuffers(1, &this->index_vbo);
     glDeleteVertexArrays(1, &this->vao);
+    this->vao = 0;
+    this->vertex_vbo = 0;
+    this->uv_vbo = 0;
+    this->index_vbo = 0;
+    this->length = 0;
+}
+
+DynamicBuffer::DynamicBuffer()
+    : target(0),
+      buffer(0),
+      region_size(0),
+      region_count(0),
+      region(0),
+      offset(0),
+      synced(false),
+      orphaned(false),
+      stats{} {}
+
+DynamicBuffer::DynamicBuffer(GLenum target, size_t region_size,
+                             size_t region_count)
+    : target(target),
+      buffer(0),
+      region_size(0),
+      region_count(region_count),
+      region(0),
+      offset(0),
+      synced(GLAD_GL_ARB_sync),
+      orphaned(false),
+      fences(region_count, nullptr),
+      stats{} {
+    if (region_count == 0) {
+        throw std::runtime_error(
+            "Tried to create a dynamic buffer, but it needs at least one "
+            "region!");
+    }
+    glGenBuffers(1, &this->buffer);
+    this->allocate(region_size);
+}
+
+DynamicBuffer::DynamicBuffer(DynamicBuffer &&other) noexcept
+    : target(other.target),
+      buffer(other.buffer),
+      region_size(other.region_size),
+      region_count(other.region_count),
+      region(other.region),
+      offset(other.offset),
+      synced(other.synced),
+      orphaned(other.orphaned),
+      fences(std::move(other.fences)),
+      stats(other.stats) {
+    other.buffer = 0;
+    other.fences.clear();
+}
+
+DynamicBuffer &DynamicBuffer::operator=(DynamicBuffer &&other) noexcept {
+    if (this != &other) {
+        this->cleanup();
+        std::swap(this->target, other.target);
+        std::swap(this->buffer, other.buffer);
+        std::swap(this->region_size, other.region_size);
+        std::swap(this->region_count, other.region_count);
+        std::swap(this->region, other.region);
+        std::swap(this->offset, other.offset);
+        std::swap(this->synced, other.synced);
+        std::swap(this->orphaned, other.orphaned);
+        std::swap(this->fences, other.fences);
+        std::swap(this->stats, other.stats);
+    }
+    return *this;
+}
+
+DynamicBuffer::~DynamicBuffer() { this->cleanup(); }
+
+void DynamicBuffer::allocate(size_t region_size) {
+    // fresh storage isn't used by the gpu yet, so the old fences are moot
+    for (GLsync &fence : this->fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    this->region_size = region_size;
+    glBindBuffer(this->target, this->buffer);
+    glBufferData(this->target, this->region_size * this->region_count,
+                 nullptr, GL_STREAM_DRAW);
+    glBindBuffer(this->target, 0);
+}
+
+void DynamicBuffer::wait_for_region() {
+    GLsync &fence = this->fences[this->region];
+    if (!fence) {
+        return;
+    }
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        // the gpu is still reading this region from an older frame
+        this->stats.stalls++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      1000000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void DynamicBuffer::begin_frame() {
+    this->region = (this->region + 1) % this->region_count;
+    this->offset = 0;
+    this->orphaned = false;
+    this->stats.frame_bytes = 0;
+    if (this->synced) {
+        this->wait_for_region();
+    }
+}
+
+void DynamicBuffer::end_frame() {
+    if (this->synced && this->offset > 0) {
+        this->fences[this->region] =
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    this->stats.last_frame_bytes = this->stats.frame_bytes;
+    this->stats.peak_frame_bytes =
+        std::max(this->stats.peak_frame_bytes, this->stats.frame_bytes);
+    this->stats.frames++;
+}
+
+size_t DynamicBuffer::upload(const void *data, size_t size, size_t align) {
+    size_t start = (this->offset + align - 1) / align * align;
+    if (start + size > this->region_size) {
+        // the frame doesn't fit into its region anymore, so all regions
+        // move to new (and if needed larger) storage. earlier draws of this
+        // frame keep reading the orphaned storage.
+        size_t region_size = std::max(this->region_size, (size_t)1);
+        while (region_size < size) {
+            region_size *= 2;
+        }
+        if (region_size != this->region_size) {
+            this->stats.resizes++;
+        } else {
+            this->stats.orphans++;
+        }
+        this->allocate(region_size);
+        this->offset = 0;
+        this->orphaned = true;
+        start = 0;
+    }
+    size_t position = this->region * this->region_size + start;
+    glBindBuffer(this->target, this->buffer);
+    if (this->synced) {
+        void *memory = glMapBufferRange(
+            this->target, (GLintptr)position, (GLsizeiptr)size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!memory) {
+            glBindBuffer(this->target, 0);
+            throw std::runtime_error(
+                "Tried to upload to a dynamic buffer, but it couldn't be "
+                "mapped!");
+        }
+        std::memcpy(memory, data, size);
+        glUnmapBuffer(this->target);
+    } else {
+        if (!this->orphaned) {
+            glBufferData(this->target, this->region_size * this->region_count,
+                         nullptr, GL_STREAM_DRAW);
+            this->orphaned = true;
+            this->stats.orphans++;
+        }
+        glBufferSubData(this->target, (GLintptr)position, (GLsizeiptr)size,
+                        data);
+    }
+    glBindBuffer(this->target, 0);
+    this->offset = start + size;
+    this->stats.frame_bytes += size;
+    this->stats.total_bytes += size;
+    this->stats.uploads++;
+    return position;
+}
+
+GLuint DynamicBuffer::get_buffer() { return this->buffer; }
+
+size_t DynamicBuffer::get_capacity() {
+    return this->region_size * this->region_count;
+}
+
+bool DynamicBuffer::is_synced() { return this->synced; }
+
+const UploadStats &DynamicBuffer::get_stats() { return this->stats; }
+
+void DynamicBuffer::reset_stats() { this->stats = UploadStats{}; }
+
+void DynamicBuffer::cleanup() {
+    for (GLsync &fence : this->fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (this->buffer == 0) {
+        return;
+    }
+    glDeleteBuffers(1, &this->buffer);
+    this->buffer = 0;
 }
 
 void Shader::check_for_error(GLuint shader) {
@@ -298,10 +780,11 @@ void Shader::check_for_error(GLuint shader) {
     }
 }
 
-Shader::Shader() {}
+Shader::Shader() : state(nullptr) {}
 
 Shader::Shader(const char *vertex_shader_source,
-               const char *fragment_shader_source) {
+               const char *fragment_shader_source)
+    : state(nullptr) {
     this->vertex_shader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(this->vertex_shader, 1, &vertex_shader_source, nullptr);
     glCompileShader(this->vertex_shader);
@@ -318,28 +801,67 @@ Shader::Shader(const char *vertex_shader_source,
     glValidateProgram(program);
 }
 
-void Shader::start() { glUseProgram(this->program); }
+void Shader::set_state(StateCache *state) { this->state = state; }
+
+void Shader::link() {
+    glLinkProgram(this->program);
+    // linking resets every uniform of the program
+    if (this->state) {
+        this->state->forget_program(this->program);
+    }
+}
+
+void Shader::start() {
+    if (this->state) {
+        this->state->use_program(this->program);
+    } else {
+        glUseProgram(this->program);
+    }
+}
+
+void Shader::stop() {
+    // with a state cache the program just stays bound until another one is
+    // needed, instead of switching back and forth around every upload
+    if (!this->state) {
+        glUseProgram(0);
+    }
+}
+
+void Shader::upload_uniform(GLint location, float x, float y, float z,
+                            float w) {
+    if (this->state) {
+        this->state->set_uniform(location, x, y, z, w);
+    } else {
+        glUniform4f(location, x, y, z, w);
+    }
+}
 
-void Shader::stop() { glUseProgram(0); }
+void Shader::upload_uniform_matrix(GLint location, const float *data) {
+    if (this->state) {
+        this->state->set_uniform_matrix(location, data);
+    } else {
+        glUniformMatrix4fv(location, 1, true, data);
+    }
+}
 
 QuadShader::QuadShader()
     : Shader(quad_vertex_shader_source, quad_fragment_shader_source) {}
 
 void QuadShader::load_uniforms() {
-    glLinkProgram(this->program);
+    this->link();
     this->transform_uni = glGetUniformLocation(this->program, "transform");
     this->ortho_uni = glGetUniformLocation(this->program, "ortho");
     this->view_uni = glGetUniformLocation(this->program, "view");
     this->atlas_uni = glGetUniformLocation(this->program, "atlas");
     this->start();
-    glUniform4f(this->atlas_uni, 0, 0, 1, 1);
+    this->upload_uniform(this->atlas_uni, 0, 0, 1, 1);
 }
 
-void QuadShader::set_transform(float *data, bool change_shader_state) {
+void QuadShader::set_transform(const float *data, bool change_shader_state) {
     if (change_shader_state) {
         this->start();
     }
-    glUniformMatrix4fv(this->transform_uni, 1, true, data);
+    this->upload_uniform_matrix(this->transform_uni, data);
     if (change_shader_state) {
         this->stop();
     }
@@ -349,7 +871,7 @@ void QuadShader::set_ortho(float *data, bool change_shader_state) {
     if (change_shader_state) {
         this->start();
     }
-    glUniformMatrix4fv(this->ortho_uni, 1, true, data);
+    this->upload_uniform_matrix(this->ortho_uni, data);
     if (change_shader_state) {
         this->stop();
     }
@@ -359,7 +881,7 @@ void QuadShader::set_view(float *data, bool change_shader_state) {
     if (change_shader_state) {
         this->start();
     }
-    glUniformMatrix4fv(this->view_uni, 1, true, data);
+    this->upload_uniform_matrix(this->view_uni, data);
     if (change_shader_state) {
         this->stop();
     }
@@ -372,14 +894,232 @@ void QuadShader::set_atlas(int16_t x, int16_t y, int16_t w, int16_t h,
     }
     float tw = 1.0f / (float)w;
     float th = 1.0f / (float)h;
-    glUniform4f(this->atlas_uni, tw * (float)x, th * (float)y, tw, th);
+    this->upload_uniform(this->atlas_uni, tw * (float)x, th * (float)y, tw,
+                         th);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+void QuadShader::set_atlas_rect(const float *rect, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform(this->atlas_uni, rect[0], rect[1], rect[2],
+                         rect[3]);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+InstancedQuadShader::InstancedQuadShader()
+    : Shader(instanced_quad_vertex_shader_source,
+             instanced_quad_fragment_shader_source) {}
+
+void InstancedQuadShader::load_uniforms() {
+    // the instance attributes need fixed locations, so the renderer can
+    // point them at its instance buffer
+    glBindAttribLocation(this->program, 0, "position");
+    glBindAttribLocation(this->program, 1, "uv");
+    glBindAttribLocation(this->program, TRANSFORM_ATTRIB,
+                         "instance_transform");
+    glBindAttribLocation(this->program, ATLAS_ATTRIB, "instance_atlas");
+    this->link();
+    this->ortho_uni = glGetUniformLocation(this->program, "ortho");
+    this->view_uni = glGetUniformLocation(this->program, "view");
+}
+
+void InstancedQuadShader::set_ortho(float *data, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform_matrix(this->ortho_uni, data);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+void InstancedQuadShader::set_view(float *data, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform_matrix(this->view_uni, data);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+MeshShader::MeshShader()
+    : Shader(mesh_vertex_shader_source, mesh_fragment_shader_source) {}
+
+void MeshShader::load_uniforms() {
+    // same attribute locations as the vaos of Mesh
+    glBindAttribLocation(this->program, 0, "position");
+    glBindAttribLocation(this->program, 1, "uv");
+    this->link();
+    this->transform_uni = glGetUniformLocation(this->program, "transform");
+    this->ortho_uni = glGetUniformLocation(this->program, "ortho");
+    this->view_uni = glGetUniformLocation(this->program, "view");
+}
+
+void MeshShader::set_transform(const float *data, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform_matrix(this->transform_uni, data);
     if (change_shader_state) {
         this->stop();
     }
 }
 
+void MeshShader::set_ortho(float *data, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform_matrix(this->ortho_uni, data);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+void MeshShader::set_view(float *data, bool change_shader_state) {
+    if (change_shader_state) {
+        this->start();
+    }
+    this->upload_uniform_matrix(this->view_uni, data);
+    if (change_shader_state) {
+        this->stop();
+    }
+}
+
+RenderQueue::RenderQueue() : last_item_count(0), last_batch_count(0) {}
+
+uint64_t RenderQueue::make_key(uint8_t layer, uint8_t shader, uint16_t texture,
+                               float depth) {
+    // flipping the sign bit (or every bit of negative values) makes the
+    // float bits sort like the floats themselves
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+    return ((uint64_t)layer) << 56 | ((uint64_t)shader) << 48 |
+           ((uint64_t)texture) << 32 | (uint64_t)bits;
+}
+
+uint16_t RenderQueue::get_texture_slot(GLuint texture) {
+    auto it = this->texture_slots.find(texture);
+    if (it != this->texture_slots.end()) {
+        return it->second;
+    }
+    if (this->texture_slots.size() > 0xFFFF)
+        throw std::runtime_error(
+            "Tried to queue a draw with texture " + std::to_string(texture) +
+            ", but the queue already knows 65536 textures!");
+    uint16_t slot = (uint16_t)this->texture_slots.size();
+    this->texture_slots.insert({texture, slot});
+    return slot;
+}
+
+void RenderQueue::submit(uint8_t layer, float depth, TextureRef &tex,
+                         Transform3D &&tf) {
+    this->submit(layer, depth, tex, tf);
+}
+
+void RenderQueue::submit(uint8_t layer, float depth, TextureRef &tex,
+                         Transform3D &tf) {
+    uint16_t slot = this->get_texture_slot(tex.texture.get_texture());
+    this->items.push_back(
+        Item{make_key(layer, QUAD_SHADER, slot, depth),
+             (uint32_t)this->quads.size()});
+    this->quads.push_back(make_sprite_instance(tex, tf));
+    this->quad_textures.push_back(tex.texture);
+}
+
+void RenderQueue::submit(uint8_t layer, float depth,
+                         std::function<void(Renderer &renderer)> draw) {
+    this->items.push_back(Item{make_key(layer, CUSTOM_SHADER, 0, depth),
+                               (uint32_t)this->customs.size()});
+    this->customs.push_back(std::move(draw));
+}
+
+size_t RenderQueue::size() { return this->items.size(); }
+
+void RenderQueue::sort() {
+    // lsd radix sort over the key bytes. it is stable, so draws with equal
+    // keys stay in submission order. bytes that are the same for every
+    // item (usually most of the layer and shader bits) are skipped.
+    size_t count = this->items.size();
+    this->sorted.resize(count);
+    for (size_t shift = 0; shift < 64; shift += 8) {
+        size_t offsets[256] = {};
+        for (const Item &item : this->items) {
+            offsets[(item.key >> shift) & 0xFF]++;
+        }
+        if (offsets[(this->items[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t total = 0;
+        for (size_t &offset : offsets) {
+            size_t bucket = offset;
+            offset = total;
+            total += bucket;
+        }
+        for (const Item &item : this->items) {
+            this->sorted[offsets[(item.key >> shift) & 0xFF]++] = item;
+        }
+        this->items.swap(this->sorted);
+    }
+}
+
+void RenderQueue::flush(Renderer &renderer) {
+    this->last_item_count = this->items.size();
+    this->last_batch_count = 0;
+    if (this->items.empty()) {
+        return;
+    }
+    this->sort();
+    // neighbouring quads with the same texture become one run, runs are
+    // only drawn when a custom draw or the end of the queue needs them to
+    this->instances.clear();
+    this->runs.clear();
+    for (const Item &item : this->items) {
+        if ((uint8_t)(item.key >> 48) == CUSTOM_SHADER) {
+            renderer.draw_sprite_runs(this->instances, this->runs);
+            this->last_batch_count += this->runs.size() + 1;
+            this->instances.clear();
+            this->runs.clear();
+            this->customs[item.index](renderer);
+            continue;
+        }
+        Texture &texture = this->quad_textures[item.index];
+        if (this->runs.empty() || this->runs.back().texture.get_texture() !=
+                                      texture.get_texture()) {
+            this->runs.push_back(SpriteRun{texture, this->instances.size(), 0});
+        }
+        this->runs.back().count++;
+        this->instances.push_back(this->quads[item.index]);
+    }
+    renderer.draw_sprite_runs(this->instances, this->runs);
+    this->last_batch_count += this->runs.size();
+    this->clear();
+}
+
+void RenderQueue::clear() {
+    // every buffer keeps its capacity for the next frame
+    this->items.clear();
+    this->quads.clear();
+    this->quad_textures.clear();
+    this->customs.clear();
+}
+
+size_t RenderQueue::get_last_item_count() { return this->last_item_count; }
+
+size_t RenderQueue::get_last_batch_count() { return this->last_batch_count; }
+
 Renderer::Renderer(Window &window, logging::Logger &logger)
-    : background(0, 0, 0, 0), logger(logger) {
+    : background(0, 0, 0, 0),
+      instancing(false),
+      sprite_draw_calls(0),
+      logger(logger) {
     (void)(window);  // TODO: use window?
     logger.debug("creating quad mesh...");
     this->quad = Mesh(
@@ -398,15 +1138,50 @@ Renderer::Renderer(Window &window, logging::Logger &logger)
             0,
         },
         std::vector<float>{0, 0, 0, 1, 1, 1, 1, 0},
-        std::vector<int>{0, 1, 2, 2, 3, 0});
+        std::vector<int>{0, 1, 2, 2, 3, 0}, &this->state);
     logger.debug("creating quad shader...");
     this->set_background_color({1.0, 1.0, 1.0, 1.0});
     this->quad_shader = QuadShader();
+    this->quad_shader.set_state(&this->state);
     this->quad_shader.load_uniforms();
+    logger.debug("creating mesh shader...");
+    this->mesh_shader.set_state(&this->state);
+    this->mesh_shader.load_uniforms();
+    // instancing is core since 3.3, the 3.0 context needs the extensions
+    this->instancing =
+        GLAD_GL_ARB_instanced_arrays && GLAD_GL_ARB_draw_instanced;
+    if (this->instancing) {
+        logger.debug("creating sprite instance buffer...");
+        this->sprite_shader.set_state(&this->state);
+        this->sprite_shader.load_uniforms();
+        this->instance_buffer =
+            DynamicBuffer(GL_ARRAY_BUFFER, 1024 * sizeof(SpriteInstance));
+        this->state.bind_vertex_array(this->quad.get_vao());
+        for (GLuint i = 0; i < 4; i++) {
+            glVertexAttribDivisorARB(InstancedQuadShader::TRANSFORM_ATTRIB + i,
+                                     1);
+        }
+        glVertexAttribDivisorARB(InstancedQuadShader::ATLAS_ATTRIB, 1);
+    } else {
+        logger.warn("instancing isn't supported, drawing sprites one by one");
+    }
     this->upload_transform(render::Transform3D());
     this->upload_view(0, 0, 0, 1);
 }
 
+void Renderer::begin_frame() {
+    if (this->instancing) {
+        this->instance_buffer.begin_frame();
+    }
+}
+
+void Renderer::end_frame() {
+    this->queue.flush(*this);
+    if (this->instancing) {
+        this->instance_buffer.end_frame();
+    }
+}
+
 void Renderer::clear() { glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); }
 
 void Renderer::upload_transform(Transform3D &&tf) {
@@ -438,12 +1213,20 @@ void Renderer::upload_ortho(float left, float right, float bottom, float top,
         1,
     };
     this->quad_shader.set_ortho(data);
+    this->mesh_shader.set_ortho(data);
+    if (this->instancing) {
+        this->sprite_shader.set_ortho(data);
+    }
 }
 
 void Renderer::upload_view(float x, float y, float z, float scale) {
     Transform3D transform =
         Transform3D().scale(scale, scale, scale).translate(-x, -y, -z);
     this->quad_shader.set_view(transform.get_data());
+    this->mesh_shader.set_view(transform.get_data());
+    if (this->instancing) {
+        this->sprite_shader.set_view(transform.get_data());
+    }
 }
 
 void Renderer::bind_texture(TextureRef &tex) {
@@ -452,13 +1235,11 @@ void Renderer::bind_texture(TextureRef &tex) {
         this->quad_shader.set_atlas(tex.offset.first, tex.offset.second,
                                     tex.size.first, tex.size.second);
     }
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex.texture.get_texture());
+    this->state.bind_texture(0, tex.texture.get_texture());
 }
 
 void Renderer::bind_texture(Texture &tex) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex.get_texture());
+    this->state.bind_texture(0, tex.get_texture());
 }
 
 void Renderer::draw_quad() {
@@ -480,31 +1261,163 @@ void Renderer::batch_bind_texture(TextureRef &tex) {
         this->quad_shader.set_atlas(tex.offset.first, tex.offset.second,
                                     tex.size.first, tex.size.second, false);
     }
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex.texture.get_texture());
+    this->state.bind_texture(0, tex.texture.get_texture());
 }
 
 void Renderer::batch_draw_quad_begin() {
     this->quad_shader.start();
-    glBindVertexArray(this->quad.get_vao());
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->quad.get_indices());
+    this->state.bind_vertex_array(this->quad.get_vao());
 }
 
-void Renderer::batch_draw_quad_end() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(0);
-    glBindVertexArray(0);
-    this->quad_shader.stop();
-}
+void Renderer::batch_draw_quad_end() { this->quad_shader.stop(); }
 
 void Renderer::batch_draw_quad() {
     glDrawElements(GL_TRIANGLES, this->quad.get_length(), GL_UNSIGNED_INT,
                    nullptr);
 }
 
+void Renderer::begin_sprites() {
+    // batches keep their capacity, only the instances of the last frame
+    // are dropped
+    for (SpriteBatch &batch : this->sprite_batches) {
+        batch.instances.clear();
+    }
+    this->sprite_draw_calls = 0;
+}
+
+void Renderer::draw_sprite(TextureRef &tex, Transform3D &&tf) {
+    this->draw_sprite(tex, tf);
+}
+
+void Renderer::draw_sprite(TextureRef &tex, Transform3D &tf) {
+    GLuint texture = tex.texture.get_texture();
+    auto it = this->sprite_batch_indices.find(texture);
+    if (it == this->sprite_batch_indices.end()) {
+        it = this->sprite_batch_indices
+                 .insert({texture, this->sprite_batches.size()})
+                 .first;
+        this->sprite_batches.push_back(SpriteBatch{tex.texture, {}});
+    }
+    this->sprite_batches[it->second].instances.push_back(
+        make_sprite_instance(tex, tf));
+}
+
+void Renderer::end_sprites() {
+    // the batches are laid out back to back, so they share a single upload
+    this->sprite_upload.clear();
+    this->sprite_runs.clear();
+    for (SpriteBatch &batch : this->sprite_batches) {
+        if (batch.instances.empty()) {
+            continue;
+        }
+        this->sprite_runs.push_back(SpriteRun{
+            batch.texture, this->sprite_upload.size(), batch.instances.size()});
+        this->sprite_upload.insert(this->sprite_upload.end(),
+                                   batch.instances.begin(),
+                                   batch.instances.end());
+    }
+    this->draw_sprite_runs(this->sprite_upload, this->sprite_runs);
+}
+
+void Renderer::draw_sprite_runs(const std::vector<SpriteInstance> &instances,
+                                const std::vector<SpriteRun> &runs) {
+    if (instances.empty()) {
+        return;
+    }
+    if (!this->instancing) {
+        this->draw_sprite_runs_fallback(instances, runs);
+        return;
+    }
+    // every run only moves the attribute pointers to its range
+    size_t base = this->instance_buffer.upload(
+        instances.data(), instances.size() * sizeof(SpriteInstance),
+        sizeof(SpriteInstance));
+    this->sprite_shader.start();
+    this->state.bind_vertex_array(this->quad.get_vao());
+    glBindBuffer(GL_ARRAY_BUFFER, this->instance_buffer.get_buffer());
+    for (GLuint i = InstancedQuadShader::TRANSFORM_ATTRIB;
+         i <= InstancedQuadShader::ATLAS_ATTRIB; i++) {
+        glEnableVertexAttribArray(i);
+    }
+    for (const SpriteRun &run : runs) {
+        size_t offset = base + run.first * sizeof(SpriteInstance);
+        for (GLuint i = 0; i < 4; i++) {
+            glVertexAttribPointer(
+                InstancedQuadShader::TRANSFORM_ATTRIB + i, 4, GL_FLOAT,
+                GL_FALSE, sizeof(SpriteInstance),
+                (void *)(offset + i * 4 * sizeof(float)));
+        }
+        glVertexAttribPointer(InstancedQuadShader::ATLAS_ATTRIB, 4, GL_FLOAT,
+                              GL_FALSE, sizeof(SpriteInstance),
+                              (void *)(offset + 16 * sizeof(float)));
+        this->state.bind_texture(0, run.texture.get_texture());
+        glDrawElementsInstancedARB(GL_TRIANGLES, this->quad.get_length(),
+                                   GL_UNSIGNED_INT, nullptr,
+                                   (GLsizei)run.count);
+        this->sprite_draw_calls++;
+    }
+    // the quad vao is shared with the non-instanced path
+    for (GLuint i = InstancedQuadShader::TRANSFORM_ATTRIB;
+         i <= InstancedQuadShader::ATLAS_ATTRIB; i++) {
+        glDisableVertexAttribArray(i);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->sprite_shader.stop();
+}
+
+void Renderer::draw_sprite_runs_fallback(
+    const std::vector<SpriteInstance> &instances,
+    const std::vector<SpriteRun> &runs) {
+    // without instancing the runs still save the texture binds
+    this->batch_draw_quad_begin();
+    for (const SpriteRun &run : runs) {
+        this->state.bind_texture(0, run.texture.get_texture());
+        for (size_t i = run.first; i < run.first + run.count; i++) {
+            const SpriteInstance &instance = instances[i];
+            this->quad_shader.set_transform(instance.transform, false);
+            this->quad_shader.set_atlas_rect(instance.atlas, false);
+            this->batch_draw_quad();
+            this->sprite_draw_calls++;
+        }
+    }
+    this->batch_draw_quad_end();
+}
+
+void Renderer::draw_mesh(Mesh &mesh, Texture &tex, Transform3D &tf) {
+    this->draw_mesh(mesh, tex, tf, 0, mesh.get_length());
+}
+
+void Renderer::draw_mesh(Mesh &mesh, Texture &tex, Transform3D &tf,
+                         GLsizei first, GLsizei count) {
+    this->draw_mesh(mesh.get_vao(), tex, tf, first, count);
+}
+
+void Renderer::draw_mesh(GLuint vao, Texture &tex, Transform3D &tf,
+                         GLsizei first, GLsizei count) {
+    if (count <= 0) {
+        return;
+    }
+    this->mesh_shader.start();
+    this->mesh_shader.set_transform(tf.get_data(), false);
+    this->state.bind_vertex_array(vao);
+    this->state.bind_texture(0, tex.get_texture());
+    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT,
+                   (void *)((size_t)first * sizeof(int)));
+    this->mesh_shader.stop();
+}
+
+RenderQueue &Renderer::get_queue() { return this->queue; }
+
+StateCache &Renderer::get_state() { return this->state; }
+
+bool Renderer::has_instancing() { return this->instancing; }
+
+size_t Renderer::get_sprite_draw_calls() { return this->sprite_draw_calls; }
+
+const UploadStats &Renderer::get_sprite_upload_stats() {
+    return this->instance_buffer.get_stats();
+}
+
 void Renderer::set_background_color(Color &&color) {
     this->background = color;
     glClearColor(color.red(), color.green(), color.blue(), color.alpha());
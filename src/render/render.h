@@ -4,14 +4,19 @@
 
 #include "../util/logging.h"
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <array>
 #include <optional>
+#include <unordered_map>
 
 typedef unsigned int GLuint;
 typedef int GLint;
 typedef int GLsizei;
+typedef unsigned int GLenum;
+typedef struct __GLsync *GLsync;
 
 namespace render {
     class Color {
@@ -64,6 +69,56 @@ namespace render {
                    const char *img_data);
     };
 
+    // shadows the GL state the renderer touches and drops calls that
+    // wouldn't change anything. code that changes this state without going
+    // through the cache has to call invalidate afterwards.
+    class StateCache {
+        static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+        static constexpr size_t TEXTURE_UNITS = 16;
+
+        struct UniformValue {
+            size_t size;
+            bool transpose;
+            std::array<float, 16> data;
+        };
+
+        GLuint program;
+        GLuint vao;
+        GLuint active_unit;
+        std::array<GLuint, TEXTURE_UNITS> textures;
+        int blend;
+        GLenum blend_src;
+        GLenum blend_dst;
+        int depth_test;
+        GLenum depth_func;
+        std::unordered_map<uint64_t, UniformValue> uniforms;
+        size_t issued;
+        size_t skipped;
+        bool count(bool changed);
+        bool change_uniform(GLint location, size_t size, bool transpose,
+                            const float *data);
+
+       public:
+        StateCache();
+        void use_program(GLuint program);
+        void bind_vertex_array(GLuint vao);
+        void bind_texture(GLuint unit, GLuint texture);
+        void set_blend(bool enabled);
+        void set_blend_func(GLenum src, GLenum dst);
+        void set_depth_test(bool enabled);
+        void set_depth_func(GLenum func);
+        void set_uniform(GLint location, float x, float y, float z, float w);
+        void set_uniform_matrix(GLint location, const float *data,
+                                bool transpose = true);
+        void forget_program(GLuint program);
+        void forget_texture(GLuint texture);
+        void forget_vertex_array(GLuint vao);
+        void invalidate();
+        size_t get_issued_calls();
+        size_t get_skipped_calls();
+        void reset_counters();
+    };
+
     class TextureRef;
 
     class Texture {
@@ -75,7 +130,9 @@ namespace render {
         static std::vector<TextureRef> create_atlas(
             std::vector<AtlasEntry> entires, bool interpolate = false);
         GLuint get_texture() const;
-        void cleanup();
+        // deleting unbinds the texture from every unit, so the cache of the
+        // renderer that drew it has to be passed to forget it
+        void cleanup(StateCache *state = nullptr);
     };
 
     class TextureRef {
@@ -87,36 +144,111 @@ namespace render {
         TextureRef(Texture texture, int16_t x, int16_t y, int16_t width,
                    int16_t height);
         bool operator==(const TextureRef &other) const;
+        std::array<float, 4> get_uv_rect() const;
     };
 
+    // owns its vao and buffers and deletes them when destroyed, so it can
+    // only be moved. with a state cache the vao is bound through it and
+    // forgotten by it when deleted, since GL hands out deleted names again.
+    // without one, uploading leaves no vao bound.
     class Mesh {
         GLuint vao;
         GLuint vertex_vbo;
         GLuint uv_vbo;
         GLuint index_vbo;
         GLsizei length;
+        StateCache *state;
+        void bind();
+        void unbind();
 
        public:
         Mesh();
         Mesh(std::vector<float> vertices, std::vector<float> uvs,
-             std::vector<int> indices);
+             std::vector<int> indices, StateCache *state = nullptr);
+        Mesh(const Mesh &) = delete;
+        Mesh &operator=(const Mesh &) = delete;
+        Mesh(Mesh &&other) noexcept;
+        Mesh &operator=(Mesh &&other) noexcept;
+        ~Mesh();
+        void update(const std::vector<float> &vertices,
+                    const std::vector<float> &uvs,
+                    const std::vector<int> &indices);
         GLuint get_vao();
         GLuint get_indices();
         GLsizei get_length();
         void cleanup();
     };
 
+    struct UploadStats {
+        size_t frame_bytes;
+        size_t last_frame_bytes;
+        size_t peak_frame_bytes;
+        size_t total_bytes;
+        size_t uploads;
+        size_t frames;
+        size_t stalls;
+        // storage replaced by storage of the same size
+        size_t orphans;
+        // storage replaced by larger storage
+        size_t resizes;
+    };
+
+    // buffer for geometry that changes every frame. it is split into one
+    // region per frame in flight and every frame writes into the next
+    // region, so uploads never touch data the gpu may still read. with
+    // ARB_sync the regions are mapped unsynchronized and guarded by
+    // fences, otherwise the storage is orphaned once per frame.
+    class DynamicBuffer {
+        GLenum target;
+        GLuint buffer;
+        size_t region_size;
+        size_t region_count;
+        size_t region;
+        size_t offset;
+        bool synced;
+        bool orphaned;
+        std::vector<GLsync> fences;
+        UploadStats stats;
+        void allocate(size_t region_size);
+        void wait_for_region();
+
+       public:
+        DynamicBuffer();
+        DynamicBuffer(GLenum target, size_t region_size,
+                      size_t region_count = 3);
+        DynamicBuffer(const DynamicBuffer &) = delete;
+        DynamicBuffer &operator=(const DynamicBuffer &) = delete;
+        DynamicBuffer(DynamicBuffer &&other) noexcept;
+        DynamicBuffer &operator=(DynamicBuffer &&other) noexcept;
+        ~DynamicBuffer();
+        void begin_frame();
+        void end_frame();
+        size_t upload(const void *data, size_t size, size_t align = 16);
+        GLuint get_buffer();
+        size_t get_capacity();
+        bool is_synced();
+        const UploadStats &get_stats();
+        void reset_stats();
+        void cleanup();
+    };
+
     class Shader {
        protected:
         GLuint program;
         GLuint vertex_shader;
         GLuint fragment_shader;
+        StateCache *state;
         void check_for_error(GLuint shader);
+        void link();
+        void upload_uniform(GLint location, float x, float y, float z,
+                            float w);
+        void upload_uniform_matrix(GLint location, const float *data);
 
        public:
         Shader();
         Shader(const char *vertex_shader_source,
                const char *fragment_shader_source);
+        void set_state(StateCache *state);
         void start();
         void stop();
     };
@@ -130,21 +262,131 @@ namespace render {
        public:
         QuadShader();
         void load_uniforms();
-        void set_transform(float *data, bool change_shader_state = true);
+        void set_transform(const float *data, bool change_shader_state = true);
         void set_ortho(float *data, bool change_shader_state = true);
         void set_view(float *data, bool change_shader_state = true);
         void set_atlas(int16_t x, int16_t y, int16_t w, int16_t h,
                        bool change_shader_state = true);
+        void set_atlas_rect(const float *rect, bool change_shader_state = true);
+    };
+
+    // draws quads whose transform and atlas rect come from per-instance
+    // vertex attributes instead of uniforms
+    class InstancedQuadShader : public Shader {
+        GLint ortho_uni;
+        GLint view_uni;
+
+       public:
+        static constexpr GLuint TRANSFORM_ATTRIB = 2;
+        static constexpr GLuint ATLAS_ATTRIB = 6;
+        InstancedQuadShader();
+        void load_uniforms();
+        void set_ortho(float *data, bool change_shader_state = true);
+        void set_view(float *data, bool change_shader_state = true);
+    };
+
+    // draws meshes whose uvs already point into the texture
+    class MeshShader : public Shader {
+        GLint transform_uni;
+        GLint ortho_uni;
+        GLint view_uni;
+
+       public:
+        MeshShader();
+        void load_uniforms();
+        void set_transform(const float *data, bool change_shader_state = true);
+        void set_ortho(float *data, bool change_shader_state = true);
+        void set_view(float *data, bool change_shader_state = true);
+    };
+
+    // per-instance data of a sprite, the transform is row-major like
+    // Transform3D
+    struct SpriteInstance {
+        float transform[16];
+        float atlas[4];
+    };
+
+    struct SpriteBatch {
+        Texture texture;
+        std::vector<SpriteInstance> instances;
+    };
+
+    // instances [first, first + count) drawn with the same texture
+    struct SpriteRun {
+        Texture texture;
+        size_t first;
+        size_t count;
+    };
+
+    class Renderer;
+
+    // collects the draws of a frame and sorts them by a 64-bit key before
+    // they reach the renderer. from the highest bits down the key holds
+    // the layer (8 bits), the shader (8 bits), the texture (16 bits) and
+    // the depth (32 bits), so each layer is drawn in order and inside a
+    // layer draws sharing state end up next to each other.
+    class RenderQueue {
+        struct Item {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        std::vector<Item> items;
+        std::vector<Item> sorted;
+        std::vector<SpriteInstance> quads;
+        std::vector<Texture> quad_textures;
+        std::vector<std::function<void(Renderer &renderer)>> customs;
+        std::unordered_map<GLuint, uint16_t> texture_slots;
+        std::vector<SpriteInstance> instances;
+        std::vector<SpriteRun> runs;
+        size_t last_item_count;
+        size_t last_batch_count;
+        uint16_t get_texture_slot(GLuint texture);
+        void sort();
+
+       public:
+        static constexpr uint8_t QUAD_SHADER = 0;
+        static constexpr uint8_t CUSTOM_SHADER = 0xFF;
+        RenderQueue();
+        static uint64_t make_key(uint8_t layer, uint8_t shader,
+                                 uint16_t texture, float depth);
+        void submit(uint8_t layer, float depth, TextureRef &tex,
+                    Transform3D &&tf);
+        void submit(uint8_t layer, float depth, TextureRef &tex,
+                    Transform3D &tf);
+        void submit(uint8_t layer, float depth,
+                    std::function<void(Renderer &renderer)> draw);
+        size_t size();
+        void flush(Renderer &renderer);
+        void clear();
+        size_t get_last_item_count();
+        size_t get_last_batch_count();
     };
 
     class Renderer {
         Mesh quad;
         Color background;
         QuadShader quad_shader;
+        InstancedQuadShader sprite_shader;
+        MeshShader mesh_shader;
+        bool instancing;
+        DynamicBuffer instance_buffer;
+        std::vector<SpriteBatch> sprite_batches;
+        std::unordered_map<GLuint, size_t> sprite_batch_indices;
+        std::vector<SpriteInstance> sprite_upload;
+        std::vector<SpriteRun> sprite_runs;
+        size_t sprite_draw_calls;
+        RenderQueue queue;
+        StateCache state;
         logging::Logger &logger;
+        void draw_sprite_runs_fallback(
+            const std::vector<SpriteInstance> &instances,
+            const std::vector<SpriteRun> &runs);
 
        public:
         Renderer(Window &window, logging::Logger &logger);
+        void begin_frame();
+        void end_frame();
         void clear();
         void upload_transform(Transform3D &&tf);
         void upload_transform(Transform3D &tf);
@@ -162,5 +404,22 @@ namespace render {
         void batch_draw_quad_begin();
         void batch_draw_quad_end();
         void batch_draw_quad();
+        void begin_sprites();
+        void draw_sprite(TextureRef &tex, Transform3D &&tf);
+        void draw_sprite(TextureRef &tex, Transform3D &tf);
+        void end_sprites();
+        void draw_sprite_runs(const std::vector<SpriteInstance> &instances,
+                              const std::vector<SpriteRun> &runs);
+        void draw_mesh(Mesh &mesh, Texture &tex, Transform3D &tf);
+        void draw_mesh(Mesh &mesh, Texture &tex, Transform3D &tf,
+                       GLsizei first, GLsizei count);
+        // draws a range of the indices of the mesh with the given vao
+        void draw_mesh(GLuint vao, Texture &tex, Transform3D &tf,
+                       GLsizei first, GLsizei count);
+        RenderQueue &get_queue();
+        StateCache &get_state();
+        bool has_instancing();
+        size_t get_sprite_draw_calls();
+        const UploadStats &get_sprite_upload_stats();
     };
 }  // namespace render
@@ -32,4 +32,81 @@ void main()
         discard;
     }
 }
-)glsl";
\ No newline at end of file
+)glsl";
+const char *instanced_quad_vertex_shader_source = R"glsl(
+#version 150 core
+
+in vec3 position;
+in vec2 uv;
+in mat4 instance_transform;
+in vec4 instance_atlas;
+out vec4 pass_color;
+out vec4 pass_atlas;
+
+uniform mat4 ortho;
+uniform mat4 view;
+
+void main()
+{
+    // the rows of the transform are uploaded as columns, so multiplying
+    // from the left applies the row-major matrix
+    vec4 world = vec4(position * 0.5, 1.0) * instance_transform;
+    gl_Position = ortho * view * world;
+    pass_color = vec4(uv, 0.0, 1.0);
+    pass_atlas = instance_atlas;
+}
+)glsl";
+
+const char *instanced_quad_fragment_shader_source = R"glsl(
+#version 150 core
+
+in vec4 pass_color;
+in vec4 pass_atlas;
+out vec4 out_color;
+
+uniform sampler2D color_tex;
+
+void main()
+{
+    vec2 coords = pass_atlas.xy + pass_color.xy * pass_atlas.zw;
+    out_color = texture(color_tex, coords);
+    if (out_color.a == 0) {
+        discard;
+    }
+}
+)glsl";
+
+const char *mesh_vertex_shader_source = R"glsl(
+#version 150 core
+
+in vec3 position;
+in vec2 uv;
+out vec2 pass_uv;
+
+uniform mat4 transform;
+uniform mat4 ortho;
+uniform mat4 view;
+
+void main()
+{
+    gl_Position = ortho * view * transform * vec4(position, 1.0);
+    pass_uv = uv;
+}
+)glsl";
+
+const char *mesh_fragment_shader_source = R"glsl(
+#version 150 core
+
+in vec2 pass_uv;
+out vec4 out_color;
+
+uniform sampler2D color_tex;
+
+void main()
+{
+    out_color = texture(color_tex, pass_uv);
+    if (out_color.a == 0) {
+        discard;
+    }
+}
+)glsl";
@@ -15,6 +15,14 @@ PythonComponent::PythonComponent(PyObject *init_function,
     Py_INCREF(update_function);
 }
 
+PythonComponent::PythonComponent(const PythonComponent &other)
+    : core::Component(other),
+      init_function_obj(other.init_function_obj),
+      update_function_obj(other.update_function_obj) {
+    Py_INCREF(this->init_function_obj);
+    Py_INCREF(this->update_function_obj);
+}
+
 PythonComponent::~PythonComponent() {
     Py_DECREF(this->init_function_obj);
     Py_DECREF(this->update_function_obj);
@@ -22,6 +22,7 @@ namespace python {
        public:
         PythonComponent(PyObject *init_function_obj,
                         PyObject *update_function_obj);
+        PythonComponent(const PythonComponent &other);
         virtual ~PythonComponent();
         virtual void update(core::Interface &interface);
         virtual void init(core::Interface &interface);
@@ -0,0 +1,171 @@
+#include "thread_pool.h"
+
+using namespace threading;
+
+namespace {
+    thread_local ThreadPool *current_pool = nullptr;
+    thread_local size_t current_queue = 0;
+}
+
+TaskGroup::TaskGroup() : pending(0) {}
+
+bool TaskGroup::is_done() const noexcept { return this->pending == 0; }
+
+ThreadPool::ThreadPool(size_t worker_count)
+    : worker_count(worker_count),
+      started(false),
+      queued(0),
+      next_queue(0),
+      running(true) {
+    // the last queue collects tasks submitted from outside the pool
+    for (size_t i = 0; i <= worker_count; i++) {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+}
+
+size_t ThreadPool::get_worker_count() const noexcept {
+    return this->worker_count;
+}
+
+void ThreadPool::start() {
+    std::call_once(this->start_flag, [this]() {
+        this->workers.reserve(this->worker_count);
+        for (size_t i = 0; i < this->worker_count; i++) {
+            this->workers.emplace_back([this, i]() { this->work(i); });
+        }
+        this->started = true;
+    });
+}
+
+bool ThreadPool::is_started() const noexcept { return this->started; }
+
+bool ThreadPool::pop_task(size_t queue, Task &task) {
+    Queue &own = *this->queues[queue];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.tasks.empty()) {
+        return false;
+    }
+    task = std::move(own.tasks.back());
+    own.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal_task(size_t thief, Task &task) {
+    size_t count = this->queues.size();
+    size_t start = this->next_queue++;
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (start + i) % count;
+        if (victim == thief) {
+            continue;
+        }
+        Queue &other = *this->queues[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::find_task(Task &task) {
+    if (this->queued == 0) {
+        return false;
+    }
+    bool found;
+    if (current_pool == this) {
+        found = this->pop_task(current_queue, task) ||
+                this->steal_task(current_queue, task);
+    } else {
+        found = this->steal_task(this->queues.size(), task);
+    }
+    if (found) {
+        this->queued--;
+    }
+    return found;
+}
+
+void ThreadPool::execute(Task &task) {
+    try {
+        task.function();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(task.group->error_mutex);
+        if (!task.group->error) {
+            task.group->error = std::current_exception();
+        }
+    }
+    task.group->pending--;
+}
+
+void ThreadPool::work(size_t index) {
+    current_pool = this;
+    current_queue = index;
+    while (this->running) {
+        Task task;
+        if (this->find_task(task)) {
+            this->execute(task);
+        } else {
+            std::unique_lock<std::mutex> lock(this->sleep_mutex);
+            this->wake.wait(lock, [this]() {
+                return !this->running || this->queued > 0;
+            });
+        }
+    }
+}
+
+void ThreadPool::submit(TaskGroup &group, std::function<void()> function) {
+    this->start();
+    group.pending++;
+    size_t queue =
+        current_pool == this ? current_queue : this->worker_count;
+    {
+        Queue &target = *this->queues[queue];
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.tasks.push_back(Task{std::move(function), &group});
+    }
+    this->queued++;
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    }
+    this->wake.notify_one();
+}
+
+bool ThreadPool::run_pending_task() {
+    Task task;
+    if (!this->find_task(task)) {
+        return false;
+    }
+    this->execute(task);
+    return true;
+}
+
+void ThreadPool::wait(TaskGroup &group) {
+    while (group.pending > 0) {
+        if (!this->run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> lock(group.error_mutex);
+    if (group.error) {
+        std::exception_ptr error = group.error;
+        group.error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    this->running = false;
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    }
+    this->wake.notify_all();
+    for (std::thread &worker : this->workers) {
+        worker.join();
+    }
+}
+
+size_t threading::default_worker_count() {
+    size_t hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
@@ -0,0 +1,105 @@
+// header for the work-stealing thread pool
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threading {
+    // counts the tasks submitted through it that haven't finished yet. the
+    // first exception thrown by one of its tasks is rethrown by wait().
+    class TaskGroup {
+        std::atomic<size_t> pending;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        friend class ThreadPool;
+
+       public:
+        TaskGroup();
+        bool is_done() const noexcept;
+    };
+
+    // every worker owns a deque: it pushes and pops its own tasks at the
+    // back and steals from the front of other workers' deques when idle.
+    // threads waiting for a TaskGroup execute tasks themselves instead of
+    // blocking, so waiting from inside a task can't deadlock. the workers
+    // are only started by the first submitted task, so a pool that never
+    // gets work never spawns threads.
+    class ThreadPool {
+        struct Task {
+            std::function<void()> function;
+            TaskGroup *group;
+        };
+
+        struct Queue {
+            std::deque<Task> tasks;
+            std::mutex mutex;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        size_t worker_count;
+        std::once_flag start_flag;
+        std::atomic<bool> started;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> queued;
+        std::atomic<size_t> next_queue;
+        std::atomic<bool> running;
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+
+        bool pop_task(size_t queue, Task &task);
+        bool steal_task(size_t thief, Task &task);
+        bool find_task(Task &task);
+        void execute(Task &task);
+        void work(size_t index);
+
+       public:
+        explicit ThreadPool(size_t worker_count);
+        ThreadPool(const ThreadPool &other) = delete;
+        size_t get_worker_count() const noexcept;
+        void start();
+        bool is_started() const noexcept;
+        void submit(TaskGroup &group, std::function<void()> function);
+        bool run_pending_task();
+        void wait(TaskGroup &group);
+        template <class F>
+        void parallel_for(size_t count, size_t chunk_size, F function);
+        ~ThreadPool();
+    };
+
+    size_t default_worker_count();
+}
+
+template <class F>
+void threading::ThreadPool::parallel_for(size_t count, size_t chunk_size,
+                                         F function) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+    if (count <= chunk_size || this->worker_count == 0) {
+        function((size_t)0, count);
+        return;
+    }
+    TaskGroup group;
+    for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+        size_t end = std::min(begin + chunk_size, count);
+        this->submit(group,
+                     [&function, begin, end]() { function(begin, end); });
+    }
+    try {
+        function((size_t)0, chunk_size);
+    } catch (...) {
+        this->wait(group);
+        throw;
+    }
+    this->wait(group);
+}
@@ -1,15 +1,17 @@
 #include "timer.h"
 
-#include <GLFW/glfw3.h>
-
 using namespace timer;
 
-Time::Time(render::Window &window) : prev_frame_time(glfwGetTime()) {
-    (void)(window);
-}
+Time::Time() : start(std::chrono::steady_clock::now()), prev_frame_time(0) {}
 
-double Time::current() { return glfwGetTime(); }
+Time::Time(render::Window &window) : Time() { (void)(window); }
+
+double Time::current() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         this->start)
+        .count();
+}
 
-double Time::delta_time() { return glfwGetTime() - this->prev_frame_time; }
+double Time::delta_time() { return this->current() - this->prev_frame_time; }
 
-void Time::_frame_complete() { this->prev_frame_time = glfwGetTime(); }
\ No newline at end of file
+void Time::_frame_complete() { this->prev_frame_time = this->current(); }
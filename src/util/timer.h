@@ -2,16 +2,22 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "../render/render.h"
 
 namespace timer {
+    // measures time on a monotonic clock, in seconds since the Time was
+    // created. doesn't need a window, so it also works headless.
     class Time {
+        std::chrono::steady_clock::time_point start;
         double prev_frame_time;
 
        public:
+        Time();
         Time(render::Window &window);
         double current();
         double delta_time();
         void _frame_complete();
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,64 @@
+#include "bench.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// replaces the global allocation functions to count every allocation the
+// benchmarks make. only counting happens here, the memory still comes from
+// malloc.
+
+namespace {
+    std::atomic<size_t> allocations(0);
+
+    void *allocate(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        void *data = std::malloc(size == 0 ? 1 : size);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        return data;
+    }
+
+    void *allocate(size_t size, std::align_val_t align) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t alignment = (size_t)align;
+        if (alignment < sizeof(void *)) {
+            alignment = sizeof(void *);
+        }
+        void *data = nullptr;
+        if (posix_memalign(&data, alignment, size == 0 ? 1 : size) != 0) {
+            throw std::bad_alloc();
+        }
+        return data;
+    }
+}
+
+size_t bench::allocation_count() noexcept {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size) { return allocate(size); }
+void *operator new[](size_t size) { return allocate(size); }
+void *operator new(size_t size, std::align_val_t align) {
+    return allocate(size, align);
+}
+void *operator new[](size_t size, std::align_val_t align) {
+    return allocate(size, align);
+}
+void operator delete(void *data) noexcept { std::free(data); }
+void operator delete[](void *data) noexcept { std::free(data); }
+void operator delete(void *data, size_t) noexcept { std::free(data); }
+void operator delete[](void *data, size_t) noexcept { std::free(data); }
+void operator delete(void *data, std::align_val_t) noexcept {
+    std::free(data);
+}
+void operator delete[](void *data, std::align_val_t) noexcept {
+    std::free(data);
+}
+void operator delete(void *data, size_t, std::align_val_t) noexcept {
+    std::free(data);
+}
+void operator delete[](void *data, size_t, std::align_val_t) noexcept {
+    std::free(data);
+}
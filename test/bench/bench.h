@@ -0,0 +1,85 @@
+// header for the engine microbenchmarks
+
+#pragma once
+
+#include <core/core.h>
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+    template <size_t N>
+    class BenchComponent : public core::Component {
+       public:
+        float value;
+        BenchComponent() : value((float)N) {}
+        virtual void init(core::Interface &interface) { (void)(interface); }
+        virtual void update(core::Interface &interface) {
+            (void)(interface);
+            this->value += 1.0f;
+        }
+        virtual bool is_unique() { return true; }
+    };
+
+    struct Result {
+        std::string name;
+        size_t operations;
+        double ns_per_op;
+        double allocs_per_op;
+    };
+
+    // allocations made through the global operator new since startup
+    size_t allocation_count() noexcept;
+
+    // runs every benchmark a few times and keeps the fastest run, which is
+    // the least disturbed by the rest of the system, and the fewest
+    // allocations of any run
+    class Suite {
+        size_t entity_count;
+        size_t repeats;
+        std::vector<Result> results;
+
+       public:
+        Suite(size_t entity_count, size_t repeats);
+        size_t get_entity_count() const noexcept;
+        template <class S, class F>
+        inline void measure(const std::string &name, size_t operations,
+                            S setup, F function);
+        const std::vector<Result> &get_results() const noexcept;
+        void print(std::ostream &out) const;
+        void write_json(std::ostream &out) const;
+    };
+
+    void lookup_benchmarks(Suite &suite);
+    void entity_benchmarks(Suite &suite);
+    void update_benchmarks(Suite &suite);
+}
+
+template <class S, class F>
+void bench::Suite::measure(const std::string &name, size_t operations,
+                           S setup, F function) {
+    double best = 0;
+    size_t fewest = 0;
+    for (size_t i = 0; i < this->repeats; i++) {
+        setup();
+        size_t before = allocation_count();
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        size_t allocations = allocation_count() - before;
+        if (i == 0 || allocations < fewest) {
+            fewest = allocations;
+        }
+        double ns = std::chrono::duration<double, std::nano>(end - start)
+                        .count() /
+                    (double)operations;
+        if (i == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    this->results.push_back(
+        Result{name, operations, best, (double)fewest / (double)operations});
+}
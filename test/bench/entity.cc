@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include <memory>
+
+// structural changes: creating and destroying entities and moving them
+// between archetypes by adding and removing components
+
+using namespace bench;
+
+void bench::entity_benchmarks(Suite &suite) {
+    const size_t entity_count = suite.get_entity_count();
+    std::unique_ptr<core::Game> game;
+    std::vector<size_t> ids(entity_count);
+
+    auto fresh_game = [&]() { game = std::make_unique<core::Game>(0); };
+    auto populated_game = [&]() {
+        fresh_game();
+        for (size_t i = 0; i < entity_count; i++) {
+            ids[i] = game->create_entity().get_id();
+        }
+    };
+
+    suite.measure("entity/create", entity_count, fresh_game, [&]() {
+        for (size_t i = 0; i < entity_count; i++) {
+            ids[i] = game->create_entity().get_id();
+        }
+    });
+    suite.measure("entity/destroy", entity_count, populated_game, [&]() {
+        for (size_t i = 0; i < entity_count; i++) {
+            game->destroy_entity(ids[i]);
+        }
+    });
+    // the second round of creations reuses the freed slots
+    suite.measure("entity/create_destroy_recycled", entity_count * 2,
+                  populated_game, [&]() {
+                      for (size_t i = 0; i < entity_count; i++) {
+                          game->destroy_entity(ids[i]);
+                      }
+                      for (size_t i = 0; i < entity_count; i++) {
+                          ids[i] = game->create_entity().get_id();
+                      }
+                  });
+    suite.measure("component/add_unique_ptr", entity_count, populated_game,
+                  [&]() {
+                      for (size_t i = 0; i < entity_count; i++) {
+                          game->add_component(
+                              ids[i], std::make_unique<BenchComponent<0>>());
+                      }
+                  });
+    suite.measure("component/emplace", entity_count, populated_game, [&]() {
+        for (size_t i = 0; i < entity_count; i++) {
+            game->emplace_component<BenchComponent<0>>(ids[i]);
+        }
+    });
+    auto with_components = [&]() {
+        populated_game();
+        for (size_t i = 0; i < entity_count; i++) {
+            game->emplace_component<BenchComponent<0>>(ids[i]);
+            game->emplace_component<BenchComponent<1>>(ids[i]);
+        }
+    };
+    suite.measure("component/remove", entity_count, with_components, [&]() {
+        for (size_t i = 0; i < entity_count; i++) {
+            game->remove_component<BenchComponent<1>>(ids[i]);
+        }
+    });
+
+    // spawning and despawning through the command buffer. the first burst
+    // happens in the setup, so the measured one runs with warm pools and
+    // buffers and should barely allocate
+    auto burst = [&]() {
+        core::Commands &commands = game->get_commands();
+        for (size_t i = 0; i < entity_count; i++) {
+            commands.emplace_component<BenchComponent<0>>(
+                commands.create_entity());
+        }
+        commands.apply(*game);
+        game->view<BenchComponent<0>>().each(
+            [&](core::Entity entity, BenchComponent<0> &) {
+                commands.destroy_entity(entity.get_id());
+            });
+        commands.apply(*game);
+    };
+    auto warm_game = [&]() {
+        fresh_game();
+        burst();
+    };
+    suite.measure("commands/spawn_despawn_burst", entity_count * 2,
+                  warm_game, burst);
+}
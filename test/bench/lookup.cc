@@ -0,0 +1,96 @@
+#include "bench.h"
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+
+// compares component lookup through the old per-entity storage (a map of
+// component vectors keyed by typeid(T).hash_code()) with the dense keys
+// and masks of the archetype storage
+
+using namespace bench;
+
+typedef std::map<size_t, std::vector<std::unique_ptr<core::Component>>>
+    LegacyComponents;
+
+template <class T>
+T &legacy_get_single_component(LegacyComponents &components) {
+    auto it = components.find(typeid(T).hash_code());
+    if (it == components.end())
+        throw std::runtime_error("Tried to get " +
+                                 std::string(typeid(T).name()) +
+                                 ", but it doesn't exist!");
+    return (T &)*it->second.at(0);
+}
+
+template <class T>
+void legacy_add(LegacyComponents &components) {
+    std::vector<std::unique_ptr<core::Component>> comp_vec;
+    comp_vec.push_back(std::make_unique<T>());
+    components.insert({typeid(T).hash_code(), std::move(comp_vec)});
+}
+
+void bench::lookup_benchmarks(Suite &suite) {
+    const size_t entity_count = suite.get_entity_count();
+    const size_t rounds = 100;
+    const size_t operations = entity_count * rounds * 2;
+
+    std::vector<LegacyComponents> legacy(entity_count);
+    for (LegacyComponents &components : legacy) {
+        legacy_add<BenchComponent<0>>(components);
+        legacy_add<BenchComponent<1>>(components);
+        legacy_add<BenchComponent<2>>(components);
+        legacy_add<BenchComponent<3>>(components);
+    }
+
+    core::Game game(0);
+    std::vector<core::Entity> entities;
+    for (size_t i = 0; i < entity_count; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<BenchComponent<0>>();
+        entity.add_component<BenchComponent<1>>();
+        entity.add_component<BenchComponent<2>>();
+        entity.add_component<BenchComponent<3>>();
+        entities.push_back(entity);
+    }
+
+    volatile float sink = 0;
+    auto no_setup = []() {};
+    suite.measure("lookup/get_single_component_legacy_map", operations,
+                  no_setup, [&]() {
+                      float sum = 0;
+                      for (size_t round = 0; round < rounds; round++) {
+                          for (LegacyComponents &components : legacy) {
+                              sum += legacy_get_single_component<
+                                         BenchComponent<1>>(components)
+                                         .value;
+                              sum += legacy_get_single_component<
+                                         BenchComponent<3>>(components)
+                                         .value;
+                          }
+                      }
+                      sink = sum;
+                  });
+    suite.measure("lookup/get_single_component", operations, no_setup, [&]() {
+        float sum = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            for (core::Entity &entity : entities) {
+                sum += entity.get_single_component<BenchComponent<1>>().value;
+                sum += entity.get_single_component<BenchComponent<3>>().value;
+            }
+        }
+        sink = sum;
+    });
+    suite.measure("lookup/has_component", operations, no_setup, [&]() {
+        size_t found = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            for (core::Entity &entity : entities) {
+                found += entity.has_component<BenchComponent<1>>();
+                found += entity.has_component<BenchComponent<3>>();
+            }
+        }
+        sink = (float)found;
+    });
+    (void)(sink);
+}
@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// usage: woodgas_bench [--entities N] [--repeats N] [--json FILE]
+// prints a table of ns/op and allocations/op and, with --json, writes the
+// same results as a JSON document ("-" writes it to stdout instead of the
+// table)
+
+using namespace bench;
+
+Suite::Suite(size_t entity_count, size_t repeats)
+    : entity_count(entity_count), repeats(repeats) {}
+
+size_t Suite::get_entity_count() const noexcept { return this->entity_count; }
+
+const std::vector<Result> &Suite::get_results() const noexcept {
+    return this->results;
+}
+
+void Suite::print(std::ostream &out) const {
+    for (const Result &result : this->results) {
+        out << std::left << std::setw(40) << result.name << std::right
+            << std::fixed << std::setprecision(2) << std::setw(12)
+            << result.ns_per_op << " ns/op" << std::setw(12)
+            << result.allocs_per_op << " allocs/op" << std::endl;
+    }
+}
+
+void Suite::write_json(std::ostream &out) const {
+    out << "{\n  \"entities\": " << this->entity_count
+        << ",\n  \"repeats\": " << this->repeats << ",\n  \"results\": [";
+    for (size_t i = 0; i < this->results.size(); i++) {
+        const Result &result = this->results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+            << "\", \"operations\": " << result.operations
+            << ", \"ns_per_op\": " << std::setprecision(4) << std::fixed
+            << result.ns_per_op << ", \"allocs_per_op\": "
+            << result.allocs_per_op << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    size_t entity_count = 10000;
+    size_t repeats = 5;
+    const char *json_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--entities") == 0) {
+            entity_count = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--repeats") == 0) {
+            repeats = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && std::strcmp(argv[i], "--json") == 0) {
+            json_path = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--entities N] [--repeats N] [--json FILE]"
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (entity_count == 0 || repeats == 0) {
+        std::cerr << "entities and repeats have to be positive" << std::endl;
+        return 1;
+    }
+
+    Suite suite(entity_count, repeats);
+    entity_benchmarks(suite);
+    lookup_benchmarks(suite);
+    update_benchmarks(suite);
+
+    if (json_path && std::strcmp(json_path, "-") == 0) {
+        suite.write_json(std::cout);
+        return 0;
+    }
+    suite.print(std::cout);
+    if (json_path) {
+        std::ofstream file(json_path);
+        if (!file) {
+            std::cerr << "couldn't open " << json_path << std::endl;
+            return 1;
+        }
+        suite.write_json(file);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "bench.h"
+
+#include <core/transform.h>
+
+#include <memory>
+#include <sstream>
+#include <utility>
+
+// whole Game::update calls over many entities, once for flat entities with
+// a growing number of component types and once for transform hierarchies
+
+using namespace bench;
+
+template <size_t... Ns>
+void add_bench_components(core::Entity entity, std::index_sequence<Ns...>) {
+    (entity.add_component<BenchComponent<Ns>>(), ...);
+}
+
+template <size_t K>
+void measure_update(Suite &suite, core::Interface &interface,
+                    core::Game &game, size_t rounds) {
+    const size_t entity_count = suite.get_entity_count();
+    for (size_t i = 0; i < entity_count; i++) {
+        add_bench_components(game.create_entity(),
+                             std::make_index_sequence<K>());
+    }
+    suite.measure("update/" + std::to_string(K) + "_types",
+                  entity_count * K * rounds, []() {},
+                  [&]() {
+                      for (size_t round = 0; round < rounds; round++) {
+                          game.update(interface);
+                      }
+                  });
+}
+
+void bench::update_benchmarks(Suite &suite) {
+    const size_t entity_count = suite.get_entity_count();
+    const size_t rounds = 20;
+    std::ostringstream log;
+    logging::Logger logger(log);
+    timer::Time time;
+
+    {
+        core::Game game(0);
+        core::Interface interface(logger, time, game);
+        measure_update<1>(suite, interface, game, rounds);
+    }
+    {
+        core::Game game(0);
+        core::Interface interface(logger, time, game);
+        measure_update<4>(suite, interface, game, rounds);
+    }
+    {
+        core::Game game(0);
+        core::Interface interface(logger, time, game);
+        measure_update<8>(suite, interface, game, rounds);
+    }
+
+    // trees with a fan-out of 4, moving the roots every update so that
+    // every world matrix has to be recomputed
+    core::Game game(0);
+    core::Interface interface(logger, time, game);
+    game.add_system(std::make_unique<core::TransformSystem>());
+    std::vector<core::Entity> roots;
+    std::vector<core::Entity> entities;
+    for (size_t i = 0; i < entity_count; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<core::TransformComponent>(1.0f, 0.0f);
+        if (i % 64 == 0) {
+            roots.push_back(entity);
+        } else {
+            game.set_parent(entity.get_id(),
+                            entities[(i - i % 64) + (i % 64 - 1) / 4]
+                                .get_id());
+        }
+        entities.push_back(entity);
+    }
+    game.init(interface);
+    suite.measure("hierarchy/update_moved_roots", entity_count * rounds,
+                  []() {},
+                  [&]() {
+                      for (size_t round = 0; round < rounds; round++) {
+                          for (core::Entity &root : roots) {
+                              root.get_single_component<
+                                      core::TransformComponent>()
+                                  .move(1.0f, 0.0f);
+                          }
+                          game.update(interface);
+                      }
+                  });
+    suite.measure("hierarchy/update_unchanged", entity_count * rounds,
+                  []() {},
+                  [&]() {
+                      for (size_t round = 0; round < rounds; round++) {
+                          game.update(interface);
+                      }
+                  });
+    // reparenting invalidates the flattened hierarchy, which is rebuilt
+    // by the next update
+    suite.measure("hierarchy/reparent_rebuild", entity_count * rounds,
+                  []() {},
+                  [&]() {
+                      for (size_t round = 0; round < rounds; round++) {
+                          size_t child = 1 + round % 63;
+                          game.set_parent(entities[child].get_id(),
+                                          roots[round % roots.size()]
+                                              .get_id());
+                          game.update(interface);
+                      }
+                  });
+}
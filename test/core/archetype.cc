@@ -0,0 +1,87 @@
+#include "test.h"
+
+#include <memory>
+#include <vector>
+
+// components keep their values while their entity moves between
+// archetypes, and removing a row from the middle doesn't disturb the rest
+
+using namespace test;
+
+int main() {
+    core::Game game(0);
+    Context context(game);
+    std::vector<size_t> ids;
+    for (int i = 0; i < 1000; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component(std::make_unique<Counter>(i));
+        if (i % 2 == 1) {
+            entity.add_component(std::make_unique<Position>((float)i, 0));
+        }
+        ids.push_back(entity.get_id());
+    }
+    // entities without components, with Counter and with Counter+Position
+    CHECK(game.get_archetype_count() == 3);
+    game.init(context.interface);
+    game.update(context.interface);
+    for (int i = 0; i < 1000; i++) {
+        core::Entity entity = game.get_entity(ids[i]);
+        CHECK(entity.get_single_component<Counter>().value == i + 1);
+        CHECK(entity.get_single_component<Counter>().inits == 1);
+        CHECK(entity.has_component<Position>() == (i % 2 == 1));
+    }
+
+    // destroying and removing move rows around inside and between
+    // archetypes
+    for (int i = 0; i < 1000; i += 3) {
+        game.destroy_entity(ids[i]);
+    }
+    for (int i = 1; i < 1000; i += 3) {
+        if (i % 2 == 1) {
+            game.get_entity(ids[i]).remove_component<Position>();
+        }
+    }
+    for (int i = 0; i < 1000; i++) {
+        if (i % 3 == 0) {
+            CHECK(!game.has_entity(ids[i]));
+            continue;
+        }
+        core::Entity entity = game.get_entity(ids[i]);
+        CHECK(entity.get_single_component<Counter>().value == i + 1);
+        bool position = i % 2 == 1 && i % 3 != 1;
+        CHECK(entity.has_component<Position>() == position);
+        if (position) {
+            CHECK(entity.get_single_component<Position>().x == (float)i);
+        }
+    }
+
+    // adding a component moves the entity back, the new column starts
+    // with the added value
+    for (int i = 1; i < 1000; i += 3) {
+        if (i % 2 == 1) {
+            game.get_entity(ids[i]).add_component(
+                std::make_unique<Position>(-1.0f, 0));
+        }
+    }
+    for (int i = 1; i < 1000; i += 3) {
+        core::Entity entity = game.get_entity(ids[i]);
+        CHECK(entity.get_single_component<Counter>().value == i + 1);
+        if (i % 2 == 1) {
+            CHECK(entity.get_single_component<Position>().x == -1.0f);
+        }
+    }
+
+    // non-unique components keep the order they were added in
+    core::Entity entity = game.create_entity();
+    entity.add_component(std::make_unique<Multi>(1));
+    entity.add_component(std::make_unique<Multi>(3));
+    entity.add_component(std::make_unique<Counter>(0));
+    game.update(context.interface);
+    std::vector<Multi *> multis = entity.get_component<Multi>();
+    CHECK(multis.size() == 2);
+    CHECK(multis[0]->value == 2 && multis[1]->value == 6);
+
+    CHECK_THROWS(entity.add_component(std::make_unique<Counter>(0)));
+    CHECK(entity.get_single_component<Counter>().value == 1);
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "test.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// views filtered by change or addition only see the rows touched since
+// the previous update, systems see every change exactly once, and moving
+// between archetypes keeps the ticks
+
+using namespace test;
+
+// counts the changed positions it sees on every update
+class ChangeReader : public core::System {
+   public:
+    size_t seen;
+    ChangeReader() : seen(0) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(interface);
+        this->seen = game.view<const Position>().changed<Position>().size();
+    }
+    virtual core::Access get_access() {
+        return core::Access().read<Position>();
+    }
+};
+
+// marks the positions in its list as changed, after the reader has run
+class ChangeWriter : public core::System {
+   public:
+    std::vector<size_t> marks;
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(interface);
+        for (size_t id : this->marks) {
+            game.mark_changed<Position>(id);
+        }
+        this->marks.clear();
+    }
+    virtual core::Access get_access() {
+        return core::Access().write<Position>();
+    }
+};
+
+void check_systems() {
+    core::Game game(2);
+    Context context(game);
+    std::unique_ptr<ChangeReader> reader = std::make_unique<ChangeReader>();
+    std::unique_ptr<ChangeWriter> writer = std::make_unique<ChangeWriter>();
+    ChangeReader &changes = *reader;
+    ChangeWriter &marks = *writer;
+    game.add_system(std::move(reader));
+    game.add_system(std::move(writer));
+    std::vector<size_t> ids;
+    for (int i = 0; i < 10; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<Position>();
+        ids.push_back(entity.get_id());
+    }
+    game.update(context.interface);
+    CHECK(changes.seen == 10);
+    game.update(context.interface);
+    CHECK(changes.seen == 0);
+    CHECK(marks.get_last_run_tick() > changes.get_last_run_tick());
+
+    // changes made after the reader ran show up in its next run only
+    marks.marks = {ids[1], ids[2]};
+    game.update(context.interface);
+    CHECK(changes.seen == 0);
+    game.update(context.interface);
+    CHECK(changes.seen == 2);
+    game.update(context.interface);
+    CHECK(changes.seen == 0);
+
+    // as do changes made between updates
+    game.mark_changed<Position>(ids[5]);
+    game.render(context.interface);
+    game.update(context.interface);
+    CHECK(changes.seen == 1);
+    game.update(context.interface);
+    CHECK(changes.seen == 0);
+}
+
+int main() {
+    core::Game game(2);
+    Context context(game);
+    std::vector<size_t> ids;
+    for (int i = 0; i < 100; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<Position>();
+        if (i % 2 == 1) {
+            entity.add_component<Counter>();
+        }
+        ids.push_back(entity.get_id());
+    }
+    game.update(context.interface);
+    CHECK(game.view<Position>().added<Position>().size() == 100);
+    game.update(context.interface);
+    game.update(context.interface);
+    CHECK(game.view<Position>().added<Position>().size() == 0);
+    CHECK(game.view<Position>().changed<Position>().size() == 0);
+
+    for (size_t index : {3, 4, 5, 50}) {
+        game.get_entity(ids[index]).mark_changed<Position>();
+    }
+    size_t rows = 0;
+    game.view<Position>().changed<Position>().each(
+        [&](Position &position) {
+            (void)(position);
+            rows++;
+        });
+    CHECK(rows == 4);
+    rows = 0;
+    game.view<Position>().changed<Position>().each_chunk(
+        [&](size_t count, Position *positions) {
+            (void)(positions);
+            rows += count;
+        });
+    CHECK(rows == 4);
+    std::atomic<size_t> parallel_rows(0);
+    game.view<const Position>().changed<Position>().each_parallel(
+        [&](const Position &position) {
+            (void)(position);
+            parallel_rows++;
+        },
+        7);
+    CHECK(parallel_rows == 4);
+    CHECK(game.view<Position>().changed<Counter>().size() == 0);
+    // only the odd entities have a Counter
+    CHECK(game.view<Position>().changed<Position>().added<Counter>(0).size() ==
+          2);
+
+    // changes stay visible for one update, or as long as asked for
+    size_t tick = game.get_tick();
+    game.update(context.interface);
+    CHECK(game.view<Position>().changed<Position>().size() == 4);
+    game.update(context.interface);
+    CHECK(game.view<Position>().changed<Position>().size() == 0);
+    CHECK(game.view<Position>().changed<Position>(tick).size() == 4);
+
+    game.get_entity(ids[3]).add_component<Multi>(1);
+    CHECK(game.get_entity(ids[3]).get_changed_tick<Position>() == tick);
+    CHECK(game.view<Position>().added<Multi>().size() == 1);
+
+    check_systems();
+    return 0;
+}
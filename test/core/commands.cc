@@ -0,0 +1,96 @@
+#include "test.h"
+
+#include <core/commands.h>
+
+#include <memory>
+
+// recorded changes are applied at the next sync point: creations first,
+// destructions last and the changes of one entity in recorded order
+
+using namespace test;
+
+class Spawner : public core::Component {
+   public:
+    int spawned;
+    Spawner() : spawned(0) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        core::Commands &commands = interface.get_game().get_commands();
+        size_t child = commands.create_entity();
+        commands.add_component(child,
+                               std::make_unique<Counter>(100 + spawned));
+        commands.set_parent(child, this->entity.get_id());
+        this->spawned++;
+        if (this->spawned == 3) {
+            commands.destroy_entity(this->entity.get_id());
+        }
+    }
+    virtual bool is_unique() { return true; }
+};
+
+class DirectCreator : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        interface.get_game().create_entity();
+    }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(2);
+    Context context(game);
+    core::Entity spawner = game.create_entity();
+    spawner.add_component(std::make_unique<Spawner>());
+
+    // the spawned counters are only updated from the frame after
+    game.update(context.interface);
+    CHECK(game.get_entity_count() == 2);
+    CHECK(game.view<Counter>().size() == 1);
+    game.update(context.interface);
+    CHECK(game.get_entity_count() == 3);
+    int sum = 0;
+    game.view<Counter>().each([&](core::Entity entity, Counter &counter) {
+        CHECK(entity.get_parent().get_id() == spawner.get_id());
+        sum += counter.value;
+    });
+    CHECK(sum == 101 + 101);
+    // the spawner destroys itself and with it its children, after the
+    // third child was created and parented
+    game.update(context.interface);
+    CHECK(game.get_entity_count() == 0);
+
+    // changes to one entity keep their order
+    core::Commands &commands = game.get_commands();
+    size_t pending = commands.create_entity();
+    CHECK(core::Commands::is_pending(pending));
+    commands.add_component(pending, std::make_unique<Position>());
+    commands.remove_component<Position>(pending);
+    commands.emplace_component<Counter>(pending, 4);
+    commands.apply(game);
+    CHECK(game.view<Counter>().size() == 1);
+    CHECK(game.view<Position>().size() == 0);
+
+    // destructions come last, even when recorded first
+    core::Entity doomed = game.create_entity();
+    commands.destroy_entity(doomed.get_id());
+    commands.emplace_component<Position>(doomed.get_id(), 1.0f, 2.0f);
+    commands.set_active(doomed.get_id(), false);
+    commands.apply(game);
+    CHECK(!game.has_entity(doomed.get_id()));
+    CHECK(commands.size() == 0);
+
+    // ids from an earlier apply aren't pending anymore, even when the
+    // current buffer created an entity at the same index
+    CHECK_THROWS(commands.destroy_entity(pending); commands.apply(game));
+    size_t current = commands.create_entity();
+    CHECK(core::entity_index(current) == core::entity_index(pending));
+    commands.emplace_component<Position>(pending, 5.0f, 0.0f);
+    CHECK_THROWS(commands.apply(game));
+    CHECK(game.view<Position>().size() == 0);
+
+    // structural changes while updating have to go through the buffer
+    game.create_entity().add_component(std::make_unique<DirectCreator>());
+    CHECK_THROWS(game.update(context.interface));
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "test.h"
+
+#include <memory>
+
+// registering component types fixes their keys in the listed order,
+// qualifiers don't change a key and used types can't be reordered
+
+using namespace test;
+
+class Unused : public Position {};
+class AlsoUnused : public Position {};
+
+int main() {
+    size_t first = core::get_component_type_count();
+    core::register_components<Counter, Position, Multi>();
+    CHECK(core::component_key<Counter>() == first);
+    CHECK(core::component_key<Position>() == first + 1);
+    CHECK(core::component_key<Multi>() == first + 2);
+    CHECK(core::component_key<const Position>() ==
+          core::component_key<Position>());
+    CHECK(core::get_component_type_count() == first + 3);
+
+    // registering again in the same order is fine, another order isn't
+    core::register_components<Counter, Position, Multi>();
+    CHECK_THROWS((core::register_components<AlsoUnused, Counter>()));
+    CHECK_THROWS((core::register_components<Position, Unused>()));
+
+    // masks are built from the keys
+    core::Game game(0);
+    core::Entity entity = game.create_entity();
+    entity.add_component(std::make_unique<Counter>());
+    entity.add_component(std::make_unique<Multi>());
+    CHECK(entity.has_component<Counter>());
+    CHECK(entity.has_component<const Multi>());
+    CHECK(!entity.has_component<Position>());
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "test.h"
+
+#include <memory>
+
+// events sent during an update are read by every system in the next
+// update, exactly once
+
+using namespace test;
+
+struct Hit {
+    size_t source;
+    float force;
+    Hit(size_t source, float force) : source(source), force(force) {}
+};
+
+class Shooter : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        interface.get_game().get_events().get<Hit>().emplace(
+            this->entity.get_id(), 1.0f);
+    }
+    virtual bool is_unique() { return true; }
+};
+
+class Reader : public core::System {
+    core::Access access;
+
+   public:
+    size_t seen;
+    float force;
+    Reader(core::Access access) : access(access), seen(0), force(0) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(interface);
+        for (const Hit &hit : game.get_events().get<Hit>().read()) {
+            this->seen++;
+            this->force += hit.force;
+        }
+    }
+    virtual core::Access get_access() { return this->access; }
+};
+
+int main() {
+    core::Game game(3);
+    Context context(game);
+    CHECK(!game.get_events().has<Hit>());
+    CHECK_THROWS(game.get_events().get<Hit>());
+    core::EventQueue<Hit> &hits = game.add_events<Hit>();
+    CHECK(game.get_events().has<Hit>());
+    for (int i = 0; i < 10; i++) {
+        game.create_entity().add_component<Shooter>();
+    }
+    // two readers that may run at the same time
+    std::unique_ptr<Reader> first =
+        std::make_unique<Reader>(core::Access().read<Counter>());
+    std::unique_ptr<Reader> second =
+        std::make_unique<Reader>(core::Access().read<Position>());
+    Reader &first_reader = *first;
+    Reader &second_reader = *second;
+    game.add_system(std::move(first));
+    game.add_system(std::move(second));
+
+    hits.send(Hit(0, 5.0f));
+    CHECK(hits.size() == 0 && hits.pending_size() == 1);
+    game.update(context.interface);
+    CHECK(first_reader.seen == 1 && second_reader.seen == 1);
+    CHECK(first_reader.force == 5.0f);
+    game.update(context.interface);
+    CHECK(first_reader.seen == 11 && second_reader.seen == 11);
+    CHECK(hits.size() == 10);
+    game.update(context.interface);
+    CHECK(first_reader.seen == 21 && second_reader.seen == 21);
+    return 0;
+}
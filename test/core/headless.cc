@@ -0,0 +1,79 @@
+#include "test.h"
+
+#include <core/headless.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+// headless runs tick without a renderer, run exactly the requested ticks
+// even when catching up, and a stop() wins against a run() no matter which
+// of them comes first
+
+using namespace test;
+
+class Ticker : public core::Component {
+   public:
+    int ticks;
+    bool rendering;
+    Ticker() : ticks(0), rendering(false) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        this->ticks++;
+        this->rendering = this->rendering || interface.has_renderer();
+    }
+    virtual bool is_unique() { return true; }
+};
+
+// takes longer than a tick, so paced runs always have to catch up
+class Slow : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        std::this_thread::sleep_for(std::chrono::milliseconds(12));
+    }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(1);
+    std::ostringstream log;
+    logging::Logger logger(log);
+    size_t id = game.create_entity().get_id();
+    game.get_entity(id).add_component<Ticker>();
+    core::Headless server(game, logger, 200.0, false);
+    server.init();
+    server.run(1000);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks == 1000);
+    CHECK(!game.get_entity(id).get_single_component<Ticker>().rendering);
+
+    // stopped before running
+    server.stop();
+    CHECK(!server.is_running());
+    server.run(10);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks == 1000);
+    server.start();
+    server.run(10);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks == 1010);
+
+    // stopped from another thread while running without a tick limit
+    server.set_paced(true);
+    std::thread stopper([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    });
+    server.run();
+    stopper.join();
+    CHECK(!server.is_running());
+    int ticks = game.get_entity(id).get_single_component<Ticker>().ticks;
+    CHECK(ticks > 1010);
+
+    // every advance is due several ticks, the run stops right at the count
+    game.create_entity().add_component<Slow>();
+    server.start();
+    server.run(10);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks ==
+          ticks + 10);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "test.h"
+
+#include <core/transform.h>
+
+#include <cmath>
+#include <memory>
+
+// world transforms follow their parents through entities without a
+// transform, after reparenting and after the parent is destroyed
+
+using namespace test;
+
+namespace {
+    bool near(float a, float b) { return std::fabs(a - b) < 1e-4f; }
+
+    core::TransformComponent &transform(core::Game &game, size_t id) {
+        return game.get_entity(id)
+            .get_single_component<core::TransformComponent>();
+    }
+}
+
+int main() {
+    core::Game game(2);
+    Context context(game);
+    game.add_system(std::make_unique<core::TransformSystem>());
+    core::Entity root = game.create_entity();
+    root.add_component(std::make_unique<core::TransformComponent>(10, 0));
+    // has no transform, so its children are relative to the root
+    core::Entity middle = game.create_entity();
+    game.set_parent(middle.get_id(), root.get_id());
+    core::Entity child = game.create_entity();
+    child.add_component(std::make_unique<core::TransformComponent>(1, 0));
+    game.set_parent(child.get_id(), middle.get_id());
+    core::Entity other = game.create_entity();
+    other.add_component(std::make_unique<core::TransformComponent>(5, 5));
+    CHECK(game.has_child(root.get_id(), middle.get_id()));
+    CHECK(game.get_parent(child.get_id()) == middle.get_id());
+
+    game.init(context.interface);
+    CHECK(near(transform(game, child.get_id()).get_world_x(), 11));
+    CHECK(near(transform(game, child.get_id()).get_world_y(), 0));
+
+    transform(game, root.get_id()).set_rotation(3.14159265f / 2);
+    game.update(context.interface);
+    CHECK(near(transform(game, child.get_id()).get_world_x(), 10));
+    CHECK(near(transform(game, child.get_id()).get_world_y(), 1));
+
+    game.set_parent(child.get_id(), other.get_id());
+    game.update(context.interface);
+    CHECK(!game.has_child(middle.get_id(), child.get_id()));
+    CHECK(near(transform(game, child.get_id()).get_world_x(), 6));
+    CHECK(near(transform(game, child.get_id()).get_world_y(), 5));
+
+    // destroying a parent takes its children with it
+    game.destroy_entity(other.get_id());
+    game.update(context.interface);
+    CHECK(!game.has_entity(child.get_id()));
+    CHECK(game.get_hierarchy().size() == 2);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "test.h"
+
+#include <core/loop.h>
+
+#include <cmath>
+
+// the loop runs whole fixed ticks for the elapsed time, carries the rest
+// over as the render alpha and drops ticks beyond its limit
+
+using namespace test;
+
+class Ticker : public core::Component {
+   public:
+    int ticks;
+    int renders;
+    float alpha;
+    Ticker() : ticks(0), renders(0), alpha(-1) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        this->ticks++;
+    }
+    virtual void render(core::Interface &interface) {
+        this->renders++;
+        this->alpha = interface.get_alpha();
+    }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(0);
+    Context context(game);
+    core::Interface &interface = context.interface;
+    size_t id = game.create_entity().get_id();
+    game.get_entity(id).add_component<Ticker>();
+    core::Loop loop(game, interface, 50.0, 4);
+    CHECK(std::fabs(interface.get_tick_length() - 0.02) < 1e-9);
+
+    CHECK(loop.advance(0.01) == 0);
+    CHECK(std::fabs(interface.get_alpha() - 0.5f) < 1e-4f);
+    CHECK(loop.advance(0.025) == 1);
+    CHECK(std::fabs(interface.get_alpha() - 0.75f) < 1e-4f);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks == 1);
+
+    // a long hitch only runs up to the limit and forgets the rest
+    CHECK(loop.advance(1.0) == 4);
+    CHECK(loop.get_dropped_ticks() > 0);
+    CHECK(interface.get_alpha() >= 0 && interface.get_alpha() < 1);
+
+    loop.render();
+    Ticker &ticker = game.get_entity(id).get_single_component<Ticker>();
+    CHECK(ticker.ticks == 5 && ticker.renders == 1);
+    CHECK(ticker.alpha == interface.get_alpha());
+
+    loop.step(1000);
+    CHECK(game.get_entity(id).get_single_component<Ticker>().ticks == 1005);
+    CHECK(loop.get_tick_count() == 1005);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// components of a type marked for parallel init are initialized
+// concurrently, and init dependencies between types are respected
+
+using namespace test;
+
+namespace {
+    std::atomic<int> heavy_done(0);
+    std::atomic<int> running(0);
+    std::atomic<int> most_running(0);
+}
+
+class Heavy : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) {
+        (void)(interface);
+        int now = ++running;
+        int most = most_running;
+        while (now > most && !most_running.compare_exchange_weak(most, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        running--;
+        heavy_done++;
+    }
+    virtual void update(core::Interface &interface) { (void)(interface); }
+    virtual bool is_unique() { return true; }
+};
+
+class After : public core::Component {
+   public:
+    int seen;
+    After() : seen(-1) {}
+    virtual void init(core::Interface &interface) {
+        (void)(interface);
+        this->seen = heavy_done;
+    }
+    virtual void update(core::Interface &interface) { (void)(interface); }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(4);
+    Context context(game);
+    for (int i = 0; i < 64; i++) {
+        core::Entity entity = game.create_entity();
+        if (i % 2 == 1) {
+            entity.add_component<Counter>();
+        }
+        entity.add_component<Heavy>();
+        if (i % 8 == 0) {
+            entity.add_component<After>();
+        }
+    }
+    game.set_parallel_init<Heavy>(4);
+    game.set_parallel_init<After>();
+    game.add_init_dependency<After, Heavy>();
+    game.init(context.interface);
+    CHECK(heavy_done == 64);
+    CHECK(most_running > 1);
+    game.view<After>().each([](After &after) { CHECK(after.seen == 64); });
+    int inits = 0;
+    game.view<Counter>().each(
+        [&](Counter &counter) { inits += counter.inits; });
+    CHECK(inits == 32);
+
+    // cycles can't be ordered
+    game.add_init_dependency<Heavy, After>();
+    CHECK_THROWS(game.init(context.interface));
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "test.h"
+
+#include <core/commands.h>
+#include <core/pool.h>
+
+#include <cstdint>
+#include <memory>
+
+// pools hand out aligned blocks and reuse freed ones, and pending
+// components of different alignments don't share a pool
+
+using namespace test;
+
+class alignas(64) Wide : public Counter {
+   public:
+    Wide(int value = 0) : Counter(value) {}
+};
+
+class alignas(128) Wider : public Position {
+   public:
+    Wider(float x = 0, float y = 0) : Position(x, y) {}
+};
+
+int main() {
+    core::Pool pool(24, 16, 4);
+    void *first = pool.allocate();
+    void *second = pool.allocate();
+    CHECK(first != second);
+    CHECK((uintptr_t)first % 16 == 0 && (uintptr_t)second % 16 == 0);
+    pool.deallocate(first);
+    CHECK(pool.allocate() == first);
+    CHECK(pool.size() == 2 && pool.capacity() == 4);
+    for (int i = 0; i < 3; i++) {
+        CHECK((uintptr_t)pool.allocate() % 16 == 0);
+    }
+    CHECK(pool.size() == 5 && pool.capacity() == 8);
+
+    core::Pool wide(sizeof(Wider), alignof(Wider), 2);
+    for (int i = 0; i < 5; i++) {
+        CHECK((uintptr_t)wide.allocate() % alignof(Wider) == 0);
+    }
+
+    // emplaced components live right in their column
+    core::Game game(0);
+    core::Entity entity = game.create_entity();
+    Counter &counter = entity.add_component<Counter>(5);
+    CHECK(counter.value == 5);
+    CHECK(&entity.get_single_component<Counter>() == &counter);
+    entity.add_component<Multi>(1);
+    CHECK(entity.add_component<Multi>(2).value == 2);
+    CHECK(entity.get_component<Multi>().size() == 2);
+
+    // over-aligned pending components survive the trip through the pools
+    core::Commands &commands = game.get_commands();
+    for (int frame = 0; frame < 3; frame++) {
+        for (int i = 0; i < 100; i++) {
+            size_t pending = commands.create_entity();
+            commands.emplace_component<Wide>(pending, i);
+            commands.emplace_component<Wider>(pending, (float)i, 2.0f);
+        }
+        commands.apply(game);
+    }
+    size_t rows = 0;
+    game.view<Wide, Wider>().each([&](Wide &wide, Wider &wider) {
+        CHECK((float)wide.value == wider.x && wider.y == 2.0f);
+        CHECK((uintptr_t)&wider % alignof(Wider) == 0);
+        rows++;
+    });
+    CHECK(rows == 300);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "test.h"
+
+#include <core/prefab.h>
+
+#include <memory>
+#include <vector>
+
+// instances are copies of the prefab's components, and a component that
+// throws while being copied rolls the whole batch back
+
+using namespace test;
+
+class Fragile : public core::Component {
+   public:
+    static int copies;
+    static int throw_at;
+    Fragile() {}
+    Fragile(const Fragile &other) : core::Component() {
+        (void)(other);
+        if (++copies == throw_at) {
+            throw std::runtime_error("Tried to copy, but failed on purpose!");
+        }
+    }
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) { (void)(interface); }
+    virtual bool is_unique() { return true; }
+};
+
+int Fragile::copies = 0;
+int Fragile::throw_at = 0;
+
+class Spawner : public core::Component {
+   public:
+    const core::Prefab *prefab;
+    Spawner() : prefab(nullptr) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        interface.get_game().get_commands().instantiate(*this->prefab, 100);
+    }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(0);
+    Context context(game);
+    core::Prefab enemy;
+    enemy.emplace<Position>(3.0f, 4.0f)
+        .add(Counter(7))
+        .emplace<Multi>(1)
+        .emplace<Multi>(2);
+    std::vector<core::Entity> enemies = game.instantiate(enemy, 1000);
+    CHECK(enemies.size() == 1000 && game.get_entity_count() == 1000);
+    // every instance got the unique components
+    CHECK((game.view<Position, Counter>().size() == 1000));
+    std::vector<Multi *> multis = enemies[123].get_component<Multi>();
+    CHECK(multis.size() == 2 && multis[0]->value == 1 &&
+          multis[1]->value == 2);
+    CHECK(enemies[5].get_single_component<Position>().y == 4.0f);
+    CHECK(enemies[999].get_single_component<Counter>().value == 7);
+    // the instances don't share their components
+    enemies[0].get_single_component<Counter>().value = 0;
+    CHECK(enemies[1].get_single_component<Counter>().value == 7);
+
+    // the fifth copy throws, none of the batch survives
+    core::Prefab fragile;
+    fragile.add(Fragile()).emplace<Position>();
+    Fragile::copies = 0;
+    Fragile::throw_at = 5;
+    CHECK_THROWS(game.instantiate(fragile, 10));
+    CHECK(game.get_entity_count() == 1000);
+    Fragile::throw_at = 0;
+    CHECK(game.instantiate(fragile, 3).size() == 3);
+    CHECK(game.get_entity_count() == 1003);
+    CHECK(game.view<Fragile>().size() == 3);
+
+    CHECK_THROWS(core::Prefab().emplace<Position>().emplace<Position>());
+
+    core::Prefab wave;
+    wave.emplace<Counter>(1);
+    game.create_entity().add_component<Spawner>().prefab = &wave;
+    game.update(context.interface);
+    CHECK(game.get_entity_count() == 1104);
+    return 0;
+}
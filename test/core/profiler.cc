@@ -0,0 +1,119 @@
+#include "test.h"
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+// with WOODGAS_PROFILE the profiler counts the updates of every component
+// type and system, estimates subtrees from them and reports to the logger
+
+using namespace test;
+
+class Slow : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    virtual bool is_unique() { return true; }
+};
+
+class Sleeper : public core::System {
+    core::Access access;
+
+   public:
+    Sleeper(core::Access access) : access(access) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    virtual core::Access get_access() { return this->access; }
+};
+
+double average(const core::ProfileSample &sample) {
+    return sample.seconds / (double)sample.calls;
+}
+
+int main() {
+    CHECK(core::Profiler::ENABLED);
+    core::Game game(2);
+    std::ostringstream log;
+    logging::Logger logger(log);
+    timer::Time time;
+    core::Interface interface(logger, time, game);
+    core::Profiler &profiler = game.get_profiler();
+
+    for (int i = 0; i < 10; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<Counter>();
+        if (i % 2 == 0) {
+            entity.add_component<Position>();
+        }
+    }
+    game.create_entity().add_component<Slow>();
+    // two systems that may run at the same time
+    game.add_system(
+        std::make_unique<Sleeper>(core::Access().write<Counter>()));
+    game.add_system(
+        std::make_unique<Sleeper>(core::Access().write<Position>()));
+
+    for (int i = 0; i < 3; i++) {
+        game.update(interface);
+    }
+    CHECK(profiler.get_frame_count() == 3);
+    CHECK(profiler.get_frame_seconds() >= 0.003);
+    core::ProfileSample counters = profiler.get_component_sample<Counter>();
+    CHECK(counters.calls == 30);
+    // one run per archetype with a Counter column and update
+    CHECK(counters.runs == 6);
+    CHECK(profiler.get_component_sample<Position>().calls == 15);
+    core::ProfileSample slow = profiler.get_component_sample<Slow>();
+    CHECK(slow.calls == 3 && slow.runs == 3);
+    CHECK(slow.seconds >= 0.003 && slow.max_seconds >= 0.001);
+    CHECK(slow.seconds >= counters.seconds);
+    CHECK(profiler.get_component_samples().size() == 3);
+
+    std::vector<core::ProfileSample> systems = profiler.get_system_samples();
+    CHECK(systems.size() == 2);
+    for (const core::ProfileSample &sample : systems) {
+        CHECK(sample.calls == 3 && sample.runs == 3);
+        CHECK(sample.seconds >= 0.003);
+        CHECK(!sample.name.empty());
+    }
+
+    // parent and child have a Counter, child and grandchild a Position
+    size_t parent = game.create_entity().get_id();
+    size_t child = game.create_entity().get_id();
+    size_t grandchild = game.create_entity().get_id();
+    game.get_entity(parent).add_component<Counter>();
+    game.get_entity(child).add_component<Counter>();
+    game.get_entity(child).add_component<Position>();
+    game.get_entity(grandchild).add_component<Position>();
+    game.set_parent(child, parent);
+    game.set_parent(grandchild, child);
+    double counter = average(profiler.get_component_sample<Counter>());
+    double position = average(profiler.get_component_sample<Position>());
+    CHECK(std::abs(profiler.estimate_subtree(game, parent) -
+                   2 * (counter + position)) < 1e-12);
+    CHECK(std::abs(profiler.estimate_subtree(game, grandchild) - position) <
+          1e-12);
+
+    // nothing is reported until the interval has passed
+    CHECK(log.str().find("profile of") == std::string::npos);
+    profiler.set_report_interval(0.001);
+    game.update(interface);
+    std::string report = log.str();
+    CHECK(report.find("profile of 4 updates") != std::string::npos);
+    CHECK(report.find(counters.name) != std::string::npos);
+    CHECK(report.find(slow.name) != std::string::npos);
+    CHECK(profiler.get_frame_count() == 0);
+    CHECK(profiler.get_component_samples().empty());
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "test.h"
+
+#include <memory>
+#include <vector>
+
+// ids of destroyed entities stay invalid even after their slot is reused
+// by a new entity or restored
+
+using namespace test;
+
+int main() {
+    core::Game game(0);
+    core::Entity first = game.create_entity();
+    size_t first_id = first.get_id();
+    first.add_component(std::make_unique<Counter>(5));
+    game.destroy_entity(first_id);
+    CHECK(!game.has_entity(first_id));
+
+    core::Entity second = game.create_entity();
+    size_t second_id = second.get_id();
+    CHECK(core::entity_index(second_id) == core::entity_index(first_id));
+    CHECK(core::entity_generation(second_id) ==
+          core::entity_generation(first_id) + 1);
+    CHECK(game.has_entity(second_id));
+    CHECK(!game.has_entity(first_id));
+    CHECK_THROWS(game.get_entity(first_id));
+    CHECK_THROWS(game.destroy_entity(first_id));
+    // the stale handle doesn't see the components of the new entity
+    second.add_component(std::make_unique<Counter>(7));
+    CHECK(!first.has_component<Counter>());
+
+    // churning through the same slots doesn't grow the registry
+    for (int round = 0; round < 100; round++) {
+        std::vector<size_t> ids;
+        for (int i = 0; i < 100; i++) {
+            core::Entity entity = game.create_entity();
+            entity.add_component(std::make_unique<Counter>(i));
+            ids.push_back(entity.get_id());
+        }
+        for (size_t id : ids) {
+            game.destroy_entity(id);
+        }
+        for (size_t id : ids) {
+            CHECK(!game.has_entity(id));
+        }
+    }
+    CHECK(game.get_entity_count() == 1);
+    CHECK(game.get_entity(second_id).get_single_component<Counter>().value ==
+          7);
+
+    // restoring can't take a slot back to an earlier generation, and a
+    // rejected restore leaves the registry as it was
+    core::Registry registry;
+    size_t old_id = registry.create();
+    registry.destroy(old_id);
+    size_t new_id = core::make_entity_id(0, 1);
+    size_t other_id = core::make_entity_id(5, 0);
+    CHECK_THROWS(registry.restore({other_id, old_id}));
+    CHECK_THROWS(registry.restore({other_id, other_id}));
+    CHECK(registry.size() == 0 && registry.capacity() == 1);
+    CHECK(!registry.contains(other_id));
+    registry.restore({new_id, other_id});
+    CHECK(registry.contains(new_id) && registry.contains(other_id));
+    CHECK(!registry.contains(old_id) && registry.is_stale(old_id));
+    CHECK(registry.capacity() == 6);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "test.h"
+
+#include <core/scheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// conflicting systems run in the order they were added, exclusive ones on
+// the calling thread, and the pool only starts once there is work for it
+
+using namespace test;
+
+class RecordingSystem : public core::System {
+    core::Access access;
+
+   public:
+    std::atomic<size_t> &clock;
+    size_t start;
+    size_t end;
+    RecordingSystem(core::Access access, std::atomic<size_t> &clock)
+        : access(access), clock(clock), start(0), end(0) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+        this->start = this->clock++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        this->end = this->clock++;
+    }
+    virtual core::Access get_access() { return this->access; }
+};
+
+class ThrowingSystem : public core::System {
+   public:
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+        throw std::runtime_error("Tried to update, but failed on purpose!");
+    }
+    virtual core::Access get_access() {
+        return core::Access().read<Position>();
+    }
+};
+
+int main() {
+    // random graphs over a handful of component keys
+    std::mt19937 random(1);
+    std::thread::id main_thread = std::this_thread::get_id();
+    core::Scheduler scheduler(4);
+    for (int round = 0; round < 20; round++) {
+        std::vector<core::Access> accesses(12);
+        for (core::Access &access : accesses) {
+            int kind = (int)(random() % 6);
+            if (kind == 0) {
+                continue;
+            }
+            access.read((size_t)(random() % 4));
+            if (kind > 2) {
+                access.write((size_t)(random() % 4));
+            }
+        }
+        std::atomic<size_t> clock(0);
+        std::vector<size_t> starts(accesses.size());
+        std::vector<size_t> ends(accesses.size());
+        std::vector<std::thread::id> threads(accesses.size());
+        scheduler.run(accesses, [&](size_t index) {
+            starts[index] = clock++;
+            threads[index] = std::this_thread::get_id();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            ends[index] = clock++;
+        });
+        CHECK(clock == accesses.size() * 2);
+        for (size_t i = 0; i < accesses.size(); i++) {
+            if (accesses[i].is_exclusive()) {
+                CHECK(threads[i] == main_thread);
+            }
+            for (size_t j = i + 1; j < accesses.size(); j++) {
+                if (accesses[i].conflicts_with(accesses[j])) {
+                    CHECK(ends[i] < starts[j]);
+                }
+            }
+        }
+    }
+
+    core::Game game(4);
+    Context context(game);
+    game.create_entity().add_component(std::make_unique<Position>());
+    game.update(context.interface);
+    CHECK(!game.get_thread_pool().is_started());
+
+    std::atomic<size_t> clock(0);
+    std::vector<RecordingSystem *> systems;
+    core::Access accesses[] = {
+        core::Access().write<Position>(), core::Access().read<Counter>(),
+        core::Access().read<Position>(), core::Access().read<Counter>(),
+        core::Access()};
+    for (core::Access &access : accesses) {
+        std::unique_ptr<RecordingSystem> system =
+            std::make_unique<RecordingSystem>(access, clock);
+        systems.push_back(system.get());
+        game.add_system(std::move(system));
+    }
+    for (int frame = 0; frame < 3; frame++) {
+        game.update(context.interface);
+        // the reader of Position waits for its writer, the exclusive system
+        // waits for everything before it
+        CHECK(systems[0]->end < systems[2]->start);
+        for (size_t i = 0; i < 4; i++) {
+            CHECK(systems[i]->end < systems[4]->start);
+        }
+    }
+    CHECK(game.get_thread_pool().is_started());
+
+    game.add_system(std::make_unique<ThrowingSystem>());
+    CHECK_THROWS(game.update(context.interface));
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "test.h"
+
+#include <core/snapshot.h>
+
+#include <string>
+#include <vector>
+
+// a saved game loads back into an empty game with the same ids, values,
+// hierarchy and enabled state, and broken data is rejected
+
+using namespace test;
+
+class Body : public core::Component {
+   public:
+    struct State {
+        float x;
+        float y;
+        float vx;
+        float vy;
+    } state;
+    Body(float x = 0, float y = 0) : state{x, y, 0, 0} {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        this->state.x += this->state.vx;
+    }
+    virtual bool is_unique() { return true; }
+};
+
+class Name : public core::Component {
+   public:
+    std::string name;
+    Name(std::string name = "") : name(name) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) { (void)(interface); }
+    virtual bool is_unique() { return false; }
+};
+
+struct Frozen {};
+
+namespace {
+    void save_name(const Name &name, core::SnapshotWriter &writer) {
+        writer.write_string(name.name);
+    }
+
+    Name load_name(core::SnapshotReader &reader) {
+        return Name(reader.read_string());
+    }
+
+    void save_counter(const Counter &counter, core::SnapshotWriter &writer) {
+        writer.write(counter.value);
+    }
+
+    Counter load_counter(core::SnapshotReader &reader) {
+        return Counter(reader.read<int>());
+    }
+}
+
+int main() {
+    core::Snapshots snapshots;
+    snapshots.add("body", &Body::state);
+    snapshots.add<Name>("name", save_name, load_name);
+    snapshots.add<Counter>("counter", save_counter, load_counter);
+    snapshots.add_tag<Frozen>("frozen");
+
+    std::vector<unsigned char> data;
+    size_t parent_id;
+    size_t child_id;
+    size_t destroyed_id;
+    {
+        core::Game game(0);
+        for (int i = 0; i < 1000; i++) {
+            core::Entity entity = game.create_entity();
+            entity.add_component<Body>((float)i, 2.0f);
+            if (i % 10 == 0) {
+                entity.add_component<Name>("a" + std::to_string(i));
+                entity.add_component<Name>("b");
+            }
+        }
+        core::Entity parent = game.create_entity();
+        parent.add_component<Counter>(42);
+        game.add_tag<Frozen>(parent.get_id());
+        parent_id = parent.get_id();
+        core::Entity child = game.create_entity();
+        game.set_parent(child.get_id(), parent_id);
+        child.set_active(false);
+        child_id = child.get_id();
+        destroyed_id = game.create_entity().get_id();
+        game.destroy_entity(destroyed_id);
+        data = snapshots.save(game);
+    }
+
+    core::Game game(0);
+    snapshots.load(game, data);
+    CHECK(game.get_entity_count() == 1002);
+    CHECK(game.view<Body>().size() == 1000);
+    size_t named = 0;
+    game.view<Body>().each([&](core::Entity entity, Body &body) {
+        CHECK(body.state.y == 2.0f);
+        if (entity.has_component<Name>()) {
+            std::vector<Name *> names = entity.get_component<Name>();
+            CHECK(names.size() == 2);
+            CHECK(names[0]->name == "a" + std::to_string((int)body.state.x));
+            CHECK(names[1]->name == "b");
+            named++;
+        }
+    });
+    CHECK(named == 100);
+    CHECK(game.get_entity(parent_id).get_single_component<Counter>().value ==
+          42);
+    CHECK(game.has_tag<Frozen>(parent_id));
+    CHECK(game.get_parent(child_id) == parent_id);
+    CHECK(game.has_child(parent_id, child_id));
+    CHECK(!game.is_enabled(child_id));
+    CHECK(!game.has_entity(destroyed_id));
+    // new entities don't reuse the ids of loaded ones
+    size_t fresh_id = game.create_entity().get_id();
+    CHECK(fresh_id != child_id && fresh_id != parent_id);
+
+    // only empty games can be loaded into, and the version has to match
+    CHECK_THROWS(snapshots.load(game, data));
+    data[4] = 9;
+    core::Game other(0);
+    CHECK_THROWS(snapshots.load(other, data));
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "test.h"
+
+#include <core/spatial.h>
+#include <core/transform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+// queries of the grid match a brute force search over all boxes, and the
+// spatial system keeps the grid in sync with world transforms
+
+using namespace test;
+
+namespace {
+    bool overlaps(const core::AABB &a, const core::AABB &b) {
+        return a.min_x <= b.max_x && b.min_x <= a.max_x &&
+               a.min_y <= b.max_y && b.min_y <= a.max_y;
+    }
+
+    bool within(const core::AABB &box, float x, float y, float radius) {
+        float dx = std::min(std::max(x, box.min_x), box.max_x) - x;
+        float dy = std::min(std::max(y, box.min_y), box.max_y) - y;
+        return dx * dx + dy * dy <= radius * radius;
+    }
+
+    // slab test of a ray of the given length against a box
+    bool hits(const core::AABB &box, float x, float y, float dx, float dy,
+              float length) {
+        float origin[2] = {x, y};
+        float direction[2] = {dx, dy};
+        float min[2] = {box.min_x, box.min_y};
+        float max[2] = {box.max_x, box.max_y};
+        float first = 0;
+        float last = length;
+        for (int axis = 0; axis < 2; axis++) {
+            if (direction[axis] == 0) {
+                if (origin[axis] < min[axis] || origin[axis] > max[axis]) {
+                    return false;
+                }
+                continue;
+            }
+            float a = (min[axis] - origin[axis]) / direction[axis];
+            float b = (max[axis] - origin[axis]) / direction[axis];
+            first = std::max(first, std::min(a, b));
+            last = std::min(last, std::max(a, b));
+            if (first > last) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    const size_t count = 2000;
+    core::SpatialIndex index(10.0f);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-200, 200);
+    std::uniform_real_distribution<float> extent(0, 15);
+    std::vector<core::AABB> boxes;
+    for (size_t i = 0; i < count; i++) {
+        float x = position(random);
+        float y = position(random);
+        float w = extent(random);
+        float h = extent(random);
+        boxes.push_back(core::AABB{x - w, y - h, x + w, y + h});
+        index.insert(i, boxes.back());
+    }
+    for (size_t i = 0; i < count; i += 3) {
+        float x = position(random);
+        float y = position(random);
+        boxes[i] = core::AABB{x - 1, y - 1, x + 1, y + 1};
+        index.update(i, boxes[i]);
+    }
+    size_t removed = 0;
+    for (size_t i = 0; i < count; i += 7) {
+        index.remove(i);
+        removed++;
+    }
+    CHECK(index.size() == count - removed);
+
+    for (int query = 0; query < 200; query++) {
+        float x = position(random);
+        float y = position(random);
+        float radius = extent(random) * 3;
+        core::AABB area{x - radius, y - radius * 0.5f, x + radius,
+                        y + radius};
+        std::vector<size_t> found;
+        index.query_aabb(area, found);
+        std::set<size_t> got(found.begin(), found.end());
+        CHECK(got.size() == found.size());
+        std::set<size_t> want;
+        for (size_t i = 0; i < count; i++) {
+            if (i % 7 != 0 && overlaps(boxes[i], area)) {
+                want.insert(i);
+            }
+        }
+        CHECK(got == want);
+
+        found.clear();
+        index.query_radius(x, y, radius, found);
+        got = std::set<size_t>(found.begin(), found.end());
+        CHECK(got.size() == found.size());
+        want.clear();
+        for (size_t i = 0; i < count; i++) {
+            if (i % 7 != 0 && within(boxes[i], x, y, radius)) {
+                want.insert(i);
+            }
+        }
+        CHECK(got == want);
+
+        // the direction doesn't have to be normalized
+        float angle = position(random);
+        float dx = query == 0 ? 1 : std::cos(angle);
+        float dy = query == 0 ? 0 : std::sin(angle);
+        std::vector<core::RayHit> ray;
+        index.raycast(x, y, dx * 3, dy * 3, 150, ray);
+        got.clear();
+        for (size_t i = 0; i < ray.size(); i++) {
+            got.insert(ray[i].entity);
+            if (i > 0) {
+                CHECK(ray[i - 1].distance <= ray[i].distance);
+            }
+        }
+        CHECK(got.size() == ray.size());
+        want.clear();
+        for (size_t i = 0; i < count; i++) {
+            if (i % 7 != 0 && hits(boxes[i], x, y, dx, dy, 150)) {
+                want.insert(i);
+            }
+        }
+        CHECK(got == want);
+    }
+
+    core::Game game(2);
+    Context context(game);
+    std::unique_ptr<core::SpatialSystem> system =
+        std::make_unique<core::SpatialSystem>(16.0f);
+    core::SpatialIndex &grid = system->get_index();
+    game.add_system(std::make_unique<core::TransformSystem>());
+    game.add_system(std::move(system));
+    core::Entity parent = game.create_entity();
+    parent.add_component<core::TransformComponent>(100.0f, 0.0f);
+    core::Entity child = game.create_entity();
+    child.add_component<core::TransformComponent>(10.0f, 0.0f);
+    child.add_component<core::SpatialComponent>(1.0f, 2.0f);
+    game.set_parent(child.get_id(), parent.get_id());
+    game.init(context.interface);
+    CHECK(grid.size() == 1);
+    core::AABB bounds = grid.get_bounds(child.get_id());
+    CHECK(bounds.min_x == 109 && bounds.max_x == 111 && bounds.min_y == -2);
+
+    // moving the parent moves the child's bounds
+    game.get_entity(parent.get_id())
+        .get_single_component<core::TransformComponent>()
+        .move(0, 50);
+    game.update(context.interface);
+    CHECK(grid.get_bounds(child.get_id()).min_y == 48);
+    std::vector<size_t> found;
+    grid.query_radius(110, 50, 1, found);
+    CHECK(found.size() == 1 && found[0] == child.get_id());
+
+    // rotated and scaled transforms grow the bounds
+    core::Entity rotated = game.create_entity();
+    rotated.add_component<core::TransformComponent>(0.0f, 0.0f, 1.5707964f,
+                                                    2.0f);
+    rotated.add_component<core::SpatialComponent>(3.0f, 1.0f);
+    game.update(context.interface);
+    CHECK(grid.size() == 2);
+    bounds = grid.get_bounds(rotated.get_id());
+    CHECK(std::fabs(bounds.max_x - 2) < 1e-3f);
+    CHECK(std::fabs(bounds.max_y - 6) < 1e-3f);
+
+    game.remove_component<core::SpatialComponent>(child.get_id());
+    game.update(context.interface);
+    CHECK(grid.size() == 1 && !grid.contains(child.get_id()));
+    game.destroy_entity(rotated.get_id());
+    game.update(context.interface);
+    CHECK(grid.size() == 0 && grid.get_cell_count() == 0);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "test.h"
+
+#include <core/prefab.h>
+
+#include <memory>
+#include <vector>
+
+// tags narrow views down without storing any data, and disabled entities
+// are skipped by updates and views until they are enabled again
+
+using namespace test;
+
+struct Enemy {};
+struct Frozen {};
+
+class Toggler : public core::System {
+   public:
+    size_t target;
+    bool threw;
+    Toggler(size_t target) : target(target), threw(false) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(interface);
+        try {
+            game.set_active(this->target, true);
+        } catch (std::runtime_error &) {
+            this->threw = true;
+        }
+        game.get_commands().set_active(this->target, true);
+        game.get_commands().add_tag<Frozen>(this->target);
+        game.get_commands().remove_tag<Enemy>(this->target);
+    }
+};
+
+int main() {
+    core::Game game(2);
+    Context context(game);
+    std::vector<size_t> ids;
+    for (int i = 0; i < 10; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<Counter>();
+        if (i % 2 == 1) {
+            entity.add_tag<Enemy>();
+        }
+        ids.push_back(entity.get_id());
+    }
+    // adding a tag twice is fine
+    game.add_tag<Enemy>(ids[1]);
+    CHECK(game.has_tag<Enemy>(ids[1]) && !game.has_tag<Enemy>(ids[0]));
+    CHECK(game.view<Counter>().with<Enemy>().size() == 5);
+    CHECK(game.view<Counter>().without<Enemy>().size() == 5);
+
+    game.set_active(ids[0], false);
+    game.set_active(ids[1], false);
+    CHECK(!game.is_enabled(ids[0]) && game.is_enabled(ids[2]));
+    CHECK(game.view<Counter>().size() == 8);
+    CHECK(game.view_all<Counter>().size() == 10);
+    CHECK(game.view_all<Counter>().with<core::Disabled>().size() == 2);
+    game.update(context.interface);
+    CHECK(game.get_entity(ids[0]).get_single_component<Counter>().value == 0);
+    CHECK(game.get_entity(ids[2]).get_single_component<Counter>().value == 1);
+
+    // time slices skip disabled entities too
+    game.set_update_interval<Counter>(2);
+    game.update(context.interface);
+    game.update(context.interface);
+    CHECK(game.get_entity(ids[0]).get_single_component<Counter>().value == 0);
+    CHECK(game.get_entity(ids[2]).get_single_component<Counter>().value == 2);
+
+    // while updating, the enabled state only changes through commands
+    game.set_update_interval<Counter>(1);
+    std::unique_ptr<Toggler> toggler = std::make_unique<Toggler>(ids[1]);
+    Toggler &toggle = *toggler;
+    game.add_system(std::move(toggler));
+    game.update(context.interface);
+    CHECK(toggle.threw);
+    CHECK(game.is_enabled(ids[1]));
+    CHECK(game.has_tag<Frozen>(ids[1]) && !game.has_tag<Enemy>(ids[1]));
+    CHECK(game.get_entity(ids[1]).get_single_component<Counter>().value == 0);
+
+    // prefabs carry tags, including the disabled state
+    core::Prefab prefab;
+    prefab.emplace<Counter>(5).add_tag<Enemy>().add_tag<core::Disabled>();
+    std::vector<core::Entity> instances = game.instantiate(prefab, 3);
+    CHECK(instances[0].has_tag<Enemy>() && !instances[0].is_enabled());
+    CHECK(game.view_all<Counter>().with<Enemy>().size() == 4 + 3);
+    CHECK(game.view<Counter>().with<Enemy>().size() == 4);
+    return 0;
+}
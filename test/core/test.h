@@ -0,0 +1,85 @@
+// header for the core behavior tests
+
+#pragma once
+
+#include <core/core.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// every test is its own executable, the first check that doesn't hold
+// prints where it is and fails the whole test
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            std::cerr << __FILE__ << ":" << __LINE__                      \
+                      << ": check failed: " #condition << std::endl;      \
+            std::exit(1);                                                 \
+        }                                                                 \
+    } while (0)
+
+#define CHECK_THROWS(statement)                                           \
+    do {                                                                  \
+        bool threw = false;                                               \
+        try {                                                             \
+            statement;                                                    \
+        } catch (std::runtime_error &) {                                  \
+            threw = true;                                                 \
+        }                                                                 \
+        CHECK(threw);                                                     \
+    } while (0)
+
+namespace test {
+    class Counter : public core::Component {
+       public:
+        int value;
+        int inits;
+        Counter(int value = 0) : value(value), inits(0) {}
+        virtual void init(core::Interface &interface) {
+            (void)(interface);
+            this->inits++;
+        }
+        virtual void update(core::Interface &interface) {
+            (void)(interface);
+            this->value++;
+        }
+        virtual bool is_unique() { return true; }
+    };
+
+    class Position : public core::Component {
+       public:
+        float x;
+        float y;
+        Position(float x = 0, float y = 0) : x(x), y(y) {}
+        virtual void init(core::Interface &interface) { (void)(interface); }
+        virtual void update(core::Interface &interface) { (void)(interface); }
+        virtual bool is_unique() { return true; }
+    };
+
+    // an entity can have any number of these
+    class Multi : public core::Component {
+       public:
+        int value;
+        Multi(int value = 0) : value(value) {}
+        virtual void init(core::Interface &interface) { (void)(interface); }
+        virtual void update(core::Interface &interface) {
+            (void)(interface);
+            this->value *= 2;
+        }
+        virtual bool is_unique() { return false; }
+    };
+
+    // interface without a window or renderer, logging into a string
+    class Context {
+        std::ostringstream log;
+        logging::Logger logger;
+        timer::Time time;
+
+       public:
+        core::Interface interface;
+        Context(core::Game &game)
+            : logger(this->log), interface(this->logger, this->time, game) {}
+    };
+}
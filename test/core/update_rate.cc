@@ -0,0 +1,105 @@
+#include "test.h"
+
+#include <chrono>
+#include <thread>
+
+// types updated every n ticks are spread evenly over those ticks, and low
+// priority types are deferred once the frame budget is spent, but never
+// for good
+
+using namespace test;
+
+class Thinker : public core::Component {
+   public:
+    int thoughts;
+    Thinker() : thoughts(0) {}
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        this->thoughts++;
+    }
+    virtual bool is_unique() { return true; }
+};
+
+class Slow : public core::Component {
+   public:
+    virtual void init(core::Interface &interface) { (void)(interface); }
+    virtual void update(core::Interface &interface) {
+        (void)(interface);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    virtual bool is_unique() { return true; }
+};
+
+int main() {
+    core::Game game(0);
+    Context context(game);
+    core::Interface &interface = context.interface;
+    for (int i = 0; i < 60; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component<Thinker>();
+        if (i % 3 == 0) {
+            entity.add_component<Position>();
+        }
+    }
+
+    // a sixth of the thinkers per update, across both archetypes
+    game.set_update_interval<Thinker>(6);
+    for (int frame = 0; frame < 6; frame++) {
+        game.update(interface);
+        int thoughts = 0;
+        game.view<Thinker>().each(
+            [&](Thinker &thinker) { thoughts += thinker.thoughts; });
+        CHECK(thoughts == 10 * (frame + 1));
+    }
+    game.view<Thinker>().each(
+        [&](Thinker &thinker) { CHECK(thinker.thoughts == 1); });
+
+    // 10Hz with a 60Hz tick is every sixth tick
+    interface._set_tick(1.0 / 60, 1);
+    game.set_update_rate<Thinker>(10.0);
+    for (int frame = 0; frame < 6; frame++) {
+        game.update(interface);
+    }
+    game.view<Thinker>().each(
+        [&](Thinker &thinker) { CHECK(thinker.thoughts == 2); });
+    game.set_update_interval<Thinker>(1);
+    game.update(interface);
+    game.view<Thinker>().each(
+        [&](Thinker &thinker) { CHECK(thinker.thoughts == 3); });
+
+    game.create_entity().add_component<Slow>();
+    size_t id = game.create_entity().get_id();
+    game.get_entity(id).add_component<Counter>();
+    game.set_update_interval<Counter>(1, core::LOW_PRIORITY);
+    game.update(interface);
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 1);
+    CHECK(game.get_deferred_updates() == 0);
+    game.set_frame_budget(0.001);
+    game.update(interface);
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 1);
+    CHECK(game.get_deferred_updates() == 1);
+    CHECK(game.get_last_update_time() >= 0.002);
+    game.set_frame_budget(0);
+    game.update(interface);
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 2);
+
+    // a slice over budget every update still runs after enough deferrals
+    game.set_frame_budget(0.001);
+    for (size_t i = 0; i < core::Game::MAX_DEFERRALS; i++) {
+        game.update(interface);
+    }
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 2);
+    CHECK(game.get_deferred_updates() == 1 + core::Game::MAX_DEFERRALS);
+    game.update(interface);
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 3);
+    game.update(interface);
+    CHECK(game.get_entity(id).get_single_component<Counter>().value == 3);
+    game.set_frame_budget(0);
+
+    // a rate means nothing without the loop's tick length
+    interface._set_tick(0, 1);
+    game.set_update_rate<Thinker>(10.0);
+    CHECK_THROWS(game.update(interface));
+    return 0;
+}
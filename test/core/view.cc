@@ -0,0 +1,78 @@
+#include "test.h"
+
+#include <memory>
+
+// views visit exactly the entities that have every requested component,
+// in chunks of one archetype each, and systems run after the components
+
+using namespace test;
+
+class SumSystem : public core::System {
+   public:
+    float total;
+    int seen;
+    SumSystem() : total(0), seen(0) {}
+    virtual void init(core::Game &game, core::Interface &interface) {
+        (void)(game);
+        (void)(interface);
+    }
+    virtual void update(core::Game &game, core::Interface &interface) {
+        (void)(interface);
+        this->total = 0;
+        this->seen = 0;
+        game.view<const Position, Counter>().each(
+            [&](const Position &position, Counter &counter) {
+                this->total += position.x;
+                counter.value += 100;
+                this->seen++;
+            });
+    }
+};
+
+int main() {
+    core::Game game(0);
+    Context context(game);
+    for (int i = 0; i < 10; i++) {
+        core::Entity entity = game.create_entity();
+        entity.add_component(std::make_unique<Position>((float)i, 0));
+        if (i < 6) {
+            entity.add_component(std::make_unique<Counter>());
+        }
+        if (i < 3) {
+            entity.add_component(std::make_unique<Multi>(1));
+        }
+    }
+    std::unique_ptr<SumSystem> system = std::make_unique<SumSystem>();
+    SumSystem &sum = *system;
+    game.add_system(std::move(system));
+    game.init(context.interface);
+    game.update(context.interface);
+    CHECK(sum.seen == 6);
+    CHECK(sum.total == 0 + 1 + 2 + 3 + 4 + 5);
+
+    // Position only, Position+Counter and Position+Counter+Multi
+    size_t chunks = 0;
+    size_t rows = 0;
+    game.view<Position>().each_chunk([&](size_t count, Position *positions) {
+        (void)(positions);
+        chunks++;
+        rows += count;
+    });
+    CHECK(chunks == 3 && rows == 10);
+
+    size_t entities = 0;
+    game.view<Counter>().each([&](core::Entity entity, Counter &counter) {
+        // the counter was updated once, then the system added 100
+        CHECK(counter.value == 101);
+        CHECK(&entity.get_single_component<Counter>() == &counter);
+        entities++;
+    });
+    CHECK(entities == 6);
+    CHECK(game.view<Counter>().size() == 6);
+    CHECK(game.view<Position>().without<Counter>().size() == 4);
+    CHECK(game.view<Position>().with<Multi>().size() == 3);
+
+    // non-unique components can't be handed out as a single column
+    CHECK_THROWS(game.view<Multi>());
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "../core/test.h"
+
+#include <render/render.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// draw keys sort by layer first, then shader, then texture and then depth,
+// with depths in the same order as the floats
+
+int main() {
+    using render::RenderQueue;
+    float depths[] = {-1e30f, -2.5f, -1.0f, -0.0f, 0.0f, 1e-20f, 0.5f,
+                      1.0f,   3.0f,  1e30f};
+    for (size_t i = 1; i < sizeof(depths) / sizeof(float); i++) {
+        CHECK(RenderQueue::make_key(0, 0, 0, depths[i - 1]) <=
+              RenderQueue::make_key(0, 0, 0, depths[i]));
+    }
+    CHECK(RenderQueue::make_key(0, 0, 0, -1.0f) <
+          RenderQueue::make_key(0, 0, 0, 1.0f));
+
+    // every field outranks all fields below it
+    uint64_t key = RenderQueue::make_key(1, 0, 0, -1e30f);
+    CHECK(RenderQueue::make_key(0, 0xFF, 0xFFFF, 1e30f) < key);
+    CHECK(RenderQueue::make_key(1, 0, 0xFFFF, 1e30f) <
+          RenderQueue::make_key(1, 1, 0, -1e30f));
+    CHECK(RenderQueue::make_key(1, 1, 0, 1e30f) <
+          RenderQueue::make_key(1, 1, 1, -1e30f));
+
+    std::vector<uint64_t> keys = {
+        RenderQueue::make_key(2, RenderQueue::QUAD_SHADER, 3, 0.5f),
+        RenderQueue::make_key(0, RenderQueue::CUSTOM_SHADER, 0, 0.0f),
+        RenderQueue::make_key(2, RenderQueue::QUAD_SHADER, 1, 9.0f),
+        RenderQueue::make_key(0, RenderQueue::QUAD_SHADER, 7, -3.0f)};
+    std::vector<uint64_t> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(sorted[0] == keys[3] && sorted[1] == keys[1]);
+    CHECK(sorted[2] == keys[2] && sorted[3] == keys[0]);
+    return 0;
+}